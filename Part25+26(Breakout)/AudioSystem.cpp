@@ -0,0 +1,242 @@
+#include "AudioSystem.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+static unsigned int readU32(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24); }
+static unsigned short readU16(const unsigned char* p) { return (unsigned short)(p[0] | (p[1] << 8)); }
+
+static void writeU32(std::ofstream& out, unsigned int v) {
+	unsigned char b[4]{ (unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24) };
+	out.write(reinterpret_cast<const char*>(b), 4);
+}
+static void writeU16(std::ofstream& out, unsigned short v) {
+	unsigned char b[2]{ (unsigned char)v, (unsigned char)(v >> 8) };
+	out.write(reinterpret_cast<const char*>(b), 2);
+}
+
+void writeWavHeader(std::ofstream& out, unsigned long long frames, unsigned int channels) {
+	unsigned int frameBytes = channels * 2;
+	unsigned int dataSize = static_cast<unsigned int>(frames * frameBytes);
+	out.write("RIFF", 4);
+	writeU32(out, 36 + dataSize);
+	out.write("WAVEfmt ", 8);
+	writeU32(out, 16);
+	writeU16(out, 1);
+	writeU16(out, static_cast<unsigned short>(channels));
+	writeU32(out, AUDIO_SAMPLE_RATE);
+	writeU32(out, AUDIO_SAMPLE_RATE * frameBytes);
+	writeU16(out, static_cast<unsigned short>(frameBytes));
+	writeU16(out, 16);
+	out.write("data", 4);
+	writeU32(out, dataSize);
+}
+
+void writeWavSamples(std::ofstream& out, const short* samples, size_t count) {
+	//through a small buffer so there's one write per few hundred samples, not per sample
+	unsigned char bytes[512];
+	while (count > 0) {
+		size_t chunk = std::min<size_t>(count, sizeof(bytes) / 2);
+		for (size_t i{ 0 }; i < chunk; ++i) {
+			unsigned short v = static_cast<unsigned short>(samples[i]);
+			bytes[i * 2] = static_cast<unsigned char>(v);
+			bytes[i * 2 + 1] = static_cast<unsigned char>(v >> 8);
+		}
+		out.write(reinterpret_cast<const char*>(bytes), chunk * 2);
+		samples += chunk;
+		count -= chunk;
+	}
+}
+
+MixerAudioBackend::MixerAudioBackend(const char* outputFile)
+	: mix(AUDIO_PERIOD_FRAMES * 2), pcm(AUDIO_PERIOD_FRAMES * 2), framesWritten(0)
+{
+	for (Voice& voice : voices) {
+		voice = Voice{ -1, 0.0, 1.0, 0.f };
+	}
+	if (outputFile) {
+		output.open(outputFile, std::ios::binary);
+		if (!output) {
+			std::cout << "ERROR::AUDIO: Failed to open " << outputFile << " for writing" << std::endl;
+		}
+		writeWavHeader(output, 0);
+	}
+}
+
+MixerAudioBackend::~MixerAudioBackend() {
+	if (output.is_open()) {
+		//now that the length is known, go back and fix up the header
+		output.seekp(0);
+		writeWavHeader(output, framesWritten);
+	}
+}
+
+bool MixerAudioBackend::load(unsigned int sound, const std::string& file) {
+	if (sounds.size() <= sound) {
+		sounds.resize(sound + 1);
+	}
+	Sound& decoded = sounds[sound];
+	decoded.samples.clear();
+	decoded.sampleRate = AUDIO_SAMPLE_RATE;
+
+	std::ifstream in(file, std::ios::binary);
+	std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	if (data.size() < 12 || std::memcmp(&data[0], "RIFF", 4) != 0 || std::memcmp(&data[8], "WAVE", 4) != 0) {
+		std::cout << "ERROR::AUDIO: " << file << " is not a WAV file, it will play as silence" << std::endl;
+		return false;
+	}
+	unsigned short format = 0, channels = 0, bits = 0;
+	for (size_t chunk{ 12 }; chunk + 8 <= data.size(); ) {
+		unsigned int size = readU32(&data[chunk + 4]);
+		const unsigned char* body = &data[chunk + 8];
+		size = static_cast<unsigned int>(std::min<size_t>(size, data.size() - chunk - 8));
+		if (std::memcmp(&data[chunk], "fmt ", 4) == 0 && size >= 16) {
+			format = readU16(body);
+			channels = readU16(body + 2);
+			decoded.sampleRate = readU32(body + 4);
+			bits = readU16(body + 14);
+		}
+		else if (std::memcmp(&data[chunk], "data", 4) == 0 && format == 1 && channels > 0 && (bits == 8 || bits == 16)) {
+			//down to mono float
+			unsigned int frameBytes = channels * bits / 8;
+			unsigned int frames = size / frameBytes;
+			decoded.samples.resize(frames);
+			for (unsigned int f{ 0 }; f < frames; ++f) {
+				float sum = 0.f;
+				for (unsigned int c{ 0 }; c < channels; ++c) {
+					const unsigned char* s = body + f * frameBytes + c * bits / 8;
+					sum += bits == 16 ? (short)readU16(s) / 32768.f : (s[0] - 128) / 128.f;
+				}
+				decoded.samples[f] = sum / channels;
+			}
+			return true;
+		}
+		chunk += 8 + size + (size & 1);
+	}
+	std::cout << "ERROR::AUDIO: " << file << " is not 8 or 16-bit PCM, it will play as silence" << std::endl;
+	return false;
+}
+
+void MixerAudioBackend::start(unsigned int voice, unsigned int sound, float volume) {
+	if (sound >= sounds.size() || sounds[sound].samples.empty()) {
+		voices[voice].sound = -1;
+		return;
+	}
+	voices[voice] = Voice{ static_cast<int>(sound), 0.0, (double)sounds[sound].sampleRate / AUDIO_SAMPLE_RATE, volume };
+}
+
+bool MixerAudioBackend::playing(unsigned int voice) {
+	return voices[voice].sound >= 0;
+}
+
+void MixerAudioBackend::update(unsigned int frames) {
+	if (mix.size() < frames * 2) {
+		mix.resize(frames * 2);
+		pcm.resize(frames * 2);
+	}
+	std::fill(mix.begin(), mix.begin() + frames * 2, 0.f);
+	for (Voice& voice : voices) {
+		if (voice.sound < 0) {
+			continue;
+		}
+		const std::vector<float>& samples = sounds[voice.sound].samples;
+		for (unsigned int f{ 0 }; f < frames; ++f) {
+			size_t s = static_cast<size_t>(voice.position);
+			if (s >= samples.size()) {
+				voice.sound = -1;
+				break;
+			}
+			float value = samples[s] * voice.volume;
+			mix[f * 2] += value;
+			mix[f * 2 + 1] += value;
+			voice.position += voice.step;
+		}
+	}
+	if (output.is_open()) {
+		for (unsigned int i{ 0 }; i < frames * 2; ++i) {
+			pcm[i] = static_cast<short>(std::max(-1.f, std::min(1.f, mix[i])) * 32767.f);
+		}
+		writeWavSamples(output, pcm.data(), frames * 2);
+		framesWritten += frames;
+	}
+}
+
+AudioSystem::AudioSystem(AudioBackend* backend)
+	: backend(backend), running(false), soundCount(0), voiceStarted(), sequence(0),
+	played(0), stolen(0), dropped(0), periods(0), busyNanoseconds(0)
+{
+}
+
+AudioSystem::~AudioSystem() {
+	stop();
+}
+
+SoundHandle AudioSystem::loadSound(const std::string& file) {
+	//a sound that fails to load keeps its handle and just plays nothing
+	backend->load(soundCount, file);
+	return SoundHandle{ soundCount++ };
+}
+
+void AudioSystem::start() {
+	if (!running.exchange(true)) {
+		thread = std::thread(&AudioSystem::run, this);
+	}
+}
+
+void AudioSystem::stop() {
+	if (running.exchange(false)) {
+		thread.join();
+	}
+}
+
+bool AudioSystem::play(SoundHandle sound, float volume) {
+	if (!queue.push(SoundCommand{ sound.Index, volume })) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+void AudioSystem::run() {
+	const std::chrono::nanoseconds period(1000000000ll * AUDIO_PERIOD_FRAMES / AUDIO_SAMPLE_RATE);
+	auto next = std::chrono::steady_clock::now();
+	while (running.load(std::memory_order_relaxed)) {
+		process();
+		next += period;
+		std::this_thread::sleep_until(next);
+	}
+}
+
+unsigned int AudioSystem::pickVoice() {
+	unsigned int oldest = 0;
+	for (unsigned int v{ 0 }; v < MAX_VOICES; ++v) {
+		if (!backend->playing(v)) {
+			return v;
+		}
+		if (voiceStarted[v] < voiceStarted[oldest]) {
+			oldest = v;
+		}
+	}
+	stolen.fetch_add(1, std::memory_order_relaxed);
+	return oldest;
+}
+
+void AudioSystem::process() {
+	auto begin = std::chrono::steady_clock::now();
+	SoundCommand command;
+	while (queue.pop(command)) {
+		unsigned int voice = pickVoice();
+		backend->start(voice, command.sound, command.volume);
+		voiceStarted[voice] = ++sequence;
+		played.fetch_add(1, std::memory_order_relaxed);
+	}
+	backend->update(AUDIO_PERIOD_FRAMES);
+	periods.fetch_add(1, std::memory_order_relaxed);
+	busyNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count(), std::memory_order_relaxed);
+}
+
+AudioSystem::Stats AudioSystem::stats() const {
+	return Stats{ played.load(), stolen.load(), dropped.load(), periods.load(), busyNanoseconds.load() / 1e9 };
+}
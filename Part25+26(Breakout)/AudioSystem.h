@@ -0,0 +1,120 @@
+#ifndef AUDIO_SYSTEM_H
+#define AUDIO_SYSTEM_H
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <fstream>
+
+#include "SpscQueue.h"
+
+//sound playback off the game thread: sounds are loaded once into a bank and referred to
+//by handle, the game thread only pushes play commands into a lock-free queue, and an
+//audio thread drains it into a fixed pool of voices, cutting off the oldest voice when
+//they're all busy. Where the sound ends up is a backend: irrKlang in the game, or the
+//software mixer below, which needs no sound device and can write what it plays to a WAV
+
+struct SoundHandle { unsigned int Index; };
+
+struct SoundCommand {
+	unsigned int sound;
+	float volume;
+};
+
+const unsigned int MAX_VOICES{ 32 };
+const size_t SOUND_QUEUE_SIZE{ 256 };
+const unsigned int AUDIO_SAMPLE_RATE{ 44100 };
+//frames per audio thread wakeup, ~5.8ms
+const unsigned int AUDIO_PERIOD_FRAMES{ 256 };
+
+//16-bit PCM WAV writing, little endian on any host: a header for frames frames of
+//channels channels with the data size filled in, then the samples, interleaved
+void writeWavHeader(std::ofstream& out, unsigned long long frames, unsigned int channels = 2);
+void writeWavSamples(std::ofstream& out, const short* samples, size_t count);
+
+//load() is only called before the audio thread starts; everything else only on it
+class AudioBackend {
+public:
+	virtual ~AudioBackend() {}
+	//decodes or preloads the file as sound number `sound`
+	virtual bool load(unsigned int sound, const std::string& file) = 0;
+	//starts a sound on a voice, cutting off whatever that voice was playing
+	virtual void start(unsigned int voice, unsigned int sound, float volume) = 0;
+	virtual bool playing(unsigned int voice) = 0;
+	//once per period, after that period's commands have been started
+	virtual void update(unsigned int /*frames*/) {}
+};
+
+//mixes the voices itself; with an output file it writes them out as a 16-bit stereo WAV,
+//without one the mix is thrown away. Decodes PCM WAV only, anything else stays silent
+class MixerAudioBackend : public AudioBackend {
+public:
+	MixerAudioBackend(const char* outputFile = nullptr);
+	~MixerAudioBackend();
+
+	bool load(unsigned int sound, const std::string& file) override;
+	void start(unsigned int voice, unsigned int sound, float volume) override;
+	bool playing(unsigned int voice) override;
+	void update(unsigned int frames) override;
+private:
+	struct Voice {
+		int sound; //-1 when idle
+		double position, step;
+		float volume;
+	};
+	//decoded sounds as mono float samples
+	struct Sound {
+		std::vector<float> samples;
+		unsigned int sampleRate;
+	};
+
+	std::vector<Sound> sounds;
+	Voice voices[MAX_VOICES];
+	std::vector<float> mix;
+	std::vector<short> pcm;
+	std::ofstream output;
+	unsigned long long framesWritten;
+};
+
+class AudioSystem {
+public:
+	struct Stats {
+		unsigned long long played, stolen, dropped, periods;
+		//time the audio thread spent draining and mixing, out of periods * period length
+		double busySeconds;
+	};
+
+	//takes ownership of the backend
+	AudioSystem(AudioBackend* backend);
+	~AudioSystem();
+
+	//only before start()
+	SoundHandle loadSound(const std::string& file);
+	void start();
+	void stop();
+	//game thread; false if the queue was full and the sound got dropped
+	bool play(SoundHandle sound, float volume = 1.f);
+	//drains the queue and runs the backend for one period on the calling thread; what
+	//the audio thread does every period, callable directly when there's no thread running
+	void process();
+
+	Stats stats() const;
+private:
+	std::unique_ptr<AudioBackend> backend;
+	SpscQueue<SoundCommand, SOUND_QUEUE_SIZE> queue;
+	std::thread thread;
+	std::atomic<bool> running;
+	unsigned int soundCount;
+
+	//start order of each voice, so the oldest can be stolen
+	unsigned long long voiceStarted[MAX_VOICES];
+	unsigned long long sequence;
+
+	std::atomic<unsigned long long> played, stolen, dropped, periods, busyNanoseconds;
+
+	void run();
+	unsigned int pickVoice();
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef BALL_SET_H
+#define BALL_SET_H
+#include <glm/glm.hpp>
+
+//room for a multi-ball power-up and the hundreds-of-balls stress modes; fixed so the
+//set stays one plain block of memory. Keep it a multiple of 4 for the SSE kernels
+const unsigned int MAX_BALLS{ 512 };
+
+//every ball in play as parallel arrays, positions are centers. All balls share one radius
+struct BallSet {
+	alignas(16) float X[MAX_BALLS];
+	alignas(16) float Y[MAX_BALLS];
+	alignas(16) float VelX[MAX_BALLS];
+	alignas(16) float VelY[MAX_BALLS];
+	//stuck balls ride on the paddle until launched
+	unsigned char Stuck[MAX_BALLS];
+	unsigned int Count;
+	float Radius;
+
+	glm::vec2 center(unsigned int i) const { return glm::vec2(X[i], Y[i]); }
+	glm::vec2 velocity(unsigned int i) const { return glm::vec2(VelX[i], VelY[i]); }
+
+	void clear() { Count = 0; }
+	//returns false when the set is full
+	bool add(glm::vec2 center, glm::vec2 velocity, bool stuck) {
+		if (Count == MAX_BALLS) {
+			return false;
+		}
+		X[Count] = center.x;
+		Y[Count] = center.y;
+		VelX[Count] = velocity.x;
+		VelY[Count] = velocity.y;
+		Stuck[Count] = stuck;
+		Count++;
+		return true;
+	}
+	//moves the last ball into slot i
+	void remove(unsigned int i) {
+		Count--;
+		X[i] = X[Count];
+		Y[i] = Y[Count];
+		VelX[i] = VelX[Count];
+		VelY[i] = VelY[Count];
+		Stuck[i] = Stuck[Count];
+	}
+};
+
+#endif
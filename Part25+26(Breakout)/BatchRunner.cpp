@@ -0,0 +1,95 @@
+#include "BatchRunner.h"
+
+#include <random>
+
+#include "InputRecording.h"
+
+const float BATCH_TICK{ 1.f / 120.f };
+
+unsigned int autopilotInput(const GameSimulation& sim, float aim) {
+	if (sim.State.state != GAME_ACTIVE) {
+		return INPUT_CONFIRM;
+	}
+	unsigned int input = INPUT_LAUNCH;
+	const BallSet& balls = sim.State.Balls;
+	unsigned int lowest = 0;
+	for (unsigned int i{ 1 }; i < balls.Count; ++i) {
+		if (balls.Y[i] > balls.Y[lowest]) lowest = i;
+	}
+	float paddleCenter = sim.State.Player.Position.x + sim.State.Player.Size.x / 2.f;
+	float target = balls.X[lowest] - aim;
+	if (target < paddleCenter - 10.f) input |= INPUT_LEFT;
+	if (target > paddleCenter + 10.f) input |= INPUT_RIGHT;
+	return input;
+}
+
+BatchRunner::BatchRunner(unsigned int width, unsigned int height)
+	: width(width), height(height)
+{
+}
+
+bool BatchRunner::addLevel(const std::string& file) {
+	GameLevel level;
+	//same size GameSimulation gives its catalog
+	level.load(file.c_str(), width, height / 2);
+	if (level.Bricks.empty()) {
+		return false;
+	}
+	files.push_back(file);
+	levels.push_back(std::move(level));
+	return true;
+}
+
+BatchResult BatchRunner::play(const BatchGame& game, unsigned long long maxTicks) const {
+	GameSimulation sim(width, height);
+	sim.Levels.add(files[game.level], levels[game.level]);
+	//Init turns a 0 seed into 1, so shift them to keep seeds 0 and 1 apart
+	sim.Init(game.seed + 1);
+
+	std::mt19937 rng(game.seed);
+	std::uniform_real_distribution<float> aimSpread(-0.4f, 0.4f);
+	std::uniform_int_distribution<int> holdTicks(10, 120), press(0, 2);
+	const unsigned int PRESSES[]{ INPUT_LEFT, INPUT_RIGHT, 0 };
+	float aim = aimSpread(rng) * sim.State.Player.Size.x;
+	unsigned int held = INPUT_LAUNCH;
+	int holdLeft = 0;
+
+	BatchResult result{ 0, 0, 0, false, 0 };
+	sim.tick(INPUT_CONFIRM, BATCH_TICK);
+	while (result.ticks < maxTicks && sim.State.state == GAME_ACTIVE) {
+		unsigned int input;
+		if (game.input == BATCH_AUTOPILOT) {
+			input = autopilotInput(sim, aim);
+		}
+		else {
+			if (holdLeft-- <= 0) {
+				held = INPUT_LAUNCH | PRESSES[press(rng)];
+				holdLeft = holdTicks(rng);
+			}
+			input = held;
+		}
+		sim.tick(input, BATCH_TICK);
+		result.ticks++;
+
+		for (const SimEvent& e : sim.Events) {
+			if (e.type == EVENT_BRICK_DESTROYED) result.bricksDestroyed++;
+			else if (e.type == EVENT_BALL_LOST) result.livesLost++;
+			//a new spot on the paddle for the next catch
+			else if (e.type == EVENT_PADDLE_HIT) aim = aimSpread(rng) * sim.State.Player.Size.x;
+		}
+	}
+	result.won = sim.State.state == GAME_WIN;
+	result.hash = hashState(sim);
+	return result;
+}
+
+std::vector<BatchResult> BatchRunner::run(ThreadPool& pool, const std::vector<BatchGame>& games, unsigned long long maxTicks) const {
+	std::vector<BatchResult> results(games.size());
+	for (size_t i{ 0 }; i < games.size(); ++i) {
+		pool.submit([this, &games, &results, i, maxTicks]() {
+			results[i] = play(games[i], maxTicks);
+		});
+	}
+	pool.wait();
+	return results;
+}
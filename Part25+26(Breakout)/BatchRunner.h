@@ -0,0 +1,56 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+#include <string>
+#include <vector>
+
+#include "GameSimulation.h"
+#include "ThreadPool.h"
+
+//plays many independent games on a ThreadPool, for level balancing: every game is its own
+//GameSimulation stepped at the fixed tick, so nothing is shared between threads apart from
+//the level templates, which are only read. No GL or audio
+
+enum BatchInput {
+	BATCH_AUTOPILOT, //follows the ball, aiming at a seeded spot on the paddle
+	BATCH_SCRIPTED   //seeded random presses, held for a random number of ticks
+};
+
+struct BatchGame {
+	unsigned int level;
+	unsigned int seed;
+	BatchInput input;
+};
+
+struct BatchResult {
+	unsigned long long ticks;
+	unsigned int bricksDestroyed;
+	unsigned int livesLost;
+	bool won;
+	//hashState at the end, the same game has to give the same hash on any thread count
+	unsigned long long hash;
+};
+
+//follows the lowest ball with the paddle and keeps the game going; aim shifts where on
+//the paddle the ball is caught, in pixels from its center
+unsigned int autopilotInput(const GameSimulation& sim, float aim = 0.f);
+
+class BatchRunner {
+public:
+	BatchRunner(unsigned int width, unsigned int height);
+
+	//loads the level once up front; games get a copy that shares its brick pages
+	bool addLevel(const std::string& file);
+	unsigned int levelCount() const { return static_cast<unsigned int>(levels.size()); }
+	const std::string& levelFile(unsigned int i) const { return files[i]; }
+
+	//plays one game until it's won, lost or has run maxTicks
+	BatchResult play(const BatchGame& game, unsigned long long maxTicks) const;
+	//plays every game on the pool, one task each; results come back in the order of games
+	std::vector<BatchResult> run(ThreadPool& pool, const std::vector<BatchGame>& games, unsigned long long maxTicks) const;
+private:
+	unsigned int width, height;
+	std::vector<std::string> files;
+	std::vector<GameLevel> levels;
+};
+
+#endif
@@ -0,0 +1,619 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+
+#include "GameSimulation.h"
+#include "LevelFile.h"
+#include "SweepKernel.h"
+#include "AudioSystem.h"
+#include "InputRecording.h"
+#include "ParticleSystem.h"
+#include "LevelGenerator.h"
+#include "BatchRunner.h"
+
+//keeps the optimizer from dropping the work we're timing
+static volatile unsigned int benchSink;
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double nsPer(BenchClock::time_point start, unsigned long long count) {
+	return std::chrono::duration<double, std::nano>(BenchClock::now() - start).count() / count;
+}
+
+//the circle-box overlap test the simulation used before the swept SoA collision, kept
+//as the narrow phase both broadphase variants run per candidate brick
+static bool circleTouchesBox(glm::vec2 center, float radius, glm::vec2 min, glm::vec2 max) {
+	glm::vec2 half((max - min) / 2.f);
+	glm::vec2 boxCenter(min + half);
+	glm::vec2 closest = boxCenter + glm::clamp(center - boxCenter, -half, half);
+	return glm::length(closest - center) < radius;
+}
+
+std::vector<unsigned char> makeTileData(unsigned int columns, unsigned int rows, unsigned char tileCode) {
+	return std::vector<unsigned char>(columns * rows, tileCode);
+}
+
+void benchBroadphase(std::ostream& out) {
+	//tiles stay the size of a shipped level's (~53x37), the level grows instead
+	const float TILE_W{ 800.f / 15.f };
+	const float TILE_H{ 300.f / 8.f };
+
+	const float RADIUS{ 12.5f };
+
+	out << std::setw(10) << "bricks" << std::setw(16) << "brute ns/ball" << std::setw(16) << "grid ns/ball" << "\n";
+	unsigned int crossover = 0;
+	for (unsigned int rows{ 1 }; rows <= 256; rows *= 2) {
+		unsigned int columns = rows * 2;
+		GameLevel level;
+		level.init(makeTileData(columns, rows).data(), columns, rows, static_cast<unsigned int>(columns * TILE_W), static_cast<unsigned int>(rows * TILE_H));
+		unsigned int bricks = level.Bricks.size();
+
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> px(0.f, columns * TILE_W), py(0.f, rows * TILE_H);
+		unsigned int samples = std::max(500u, 20000000u / bricks);
+		std::vector<glm::vec2> positions(samples);
+		for (glm::vec2& p : positions) {
+			p = glm::vec2(px(rng), py(rng));
+		}
+
+		unsigned int hits = 0;
+		auto start = BenchClock::now();
+		for (const glm::vec2& p : positions) {
+			for (unsigned int i{ 0 }; i < bricks; ++i) {
+				hits += circleTouchesBox(p + RADIUS, RADIUS, level.Bricks.Min[i], level.Bricks.Max[i]);
+			}
+		}
+		double brute = nsPer(start, samples);
+
+		start = BenchClock::now();
+		for (const glm::vec2& p : positions) {
+			level.queryArea(p, p + 2.f * RADIUS, [&](unsigned int i) {
+				hits += circleTouchesBox(p + RADIUS, RADIUS, level.Bricks.Min[i], level.Bricks.Max[i]);
+			});
+		}
+		double grid = nsPer(start, samples);
+		benchSink = hits;
+
+		if (crossover == 0 && grid < brute) {
+			crossover = bricks;
+		}
+		out << std::setw(10) << bricks << std::setw(16) << std::fixed << std::setprecision(1) << brute << std::setw(16) << grid << "\n";
+	}
+	out << "grid query is faster from " << crossover << " bricks\n";
+}
+
+//the brick layout before BrickStore: a whole GameObject per brick, with the
+//Texture2D (nine unsigned ints) it used to embed and a vtable pointer
+struct AosBrick {
+	glm::vec2 Position, Size, Velocity;
+	glm::vec3 Color;
+	float Rotation;
+	bool IsSolid, Destroyed;
+	unsigned int Sprite[9];
+	virtual ~AosBrick() {}
+};
+
+static bool ballOverlaps(glm::vec2 center, float radius, glm::vec2 min, glm::vec2 max) {
+	glm::vec2 closest = glm::clamp(center, min, max);
+	glm::vec2 d = center - closest;
+	return glm::dot(d, d) < radius * radius;
+}
+
+void benchBrickLayout(std::ostream& out) {
+	//big enough that neither layout fits in cache
+	const unsigned int COLUMNS{ 2048 }, ROWS{ 512 }, PASSES{ 8 };
+	GameLevel level;
+	level.init(makeTileData(COLUMNS, ROWS).data(), COLUMNS, ROWS, COLUMNS * 40, ROWS * 20);
+	BrickStore& soa = level.Bricks;
+	unsigned int count = soa.size();
+
+	std::vector<AosBrick> aos(count);
+	std::mt19937 rng(1234);
+	for (unsigned int i{ 0 }; i < count; ++i) {
+		aos[i].Position = soa.Min[i];
+		aos[i].Size = soa.Max[i] - soa.Min[i];
+		aos[i].Color = soa.Color[i];
+		aos[i].IsSolid = false;
+		aos[i].Destroyed = rng() & 1;
+		if (aos[i].Destroyed) {
+			soa.destroy(i);
+		}
+	}
+	std::uniform_real_distribution<float> px(0.f, COLUMNS * 40.f), py(0.f, ROWS * 20.f);
+	std::vector<glm::vec2> balls(PASSES);
+	for (glm::vec2& b : balls) {
+		b = glm::vec2(px(rng), py(rng));
+	}
+
+	//what doCollision reads for every candidate brick
+	unsigned int hits = 0;
+	auto start = BenchClock::now();
+	for (glm::vec2 b : balls) {
+		for (const AosBrick& brick : aos) {
+			if (!brick.Destroyed && ballOverlaps(b, 12.5f, brick.Position, brick.Position + brick.Size)) hits++;
+		}
+	}
+	double aosCollide = nsPer(start, (unsigned long long)count * PASSES);
+
+	start = BenchClock::now();
+	for (glm::vec2 b : balls) {
+		for (unsigned int i{ 0 }; i < count; ++i) {
+			if (!soa.isDestroyed(i) && ballOverlaps(b, 12.5f, soa.Min[i], soa.Max[i])) hits++;
+		}
+	}
+	double soaCollide = nsPer(start, (unsigned long long)count * PASSES);
+
+	//worst case for isCompleted: only the very last brick is left standing
+	for (unsigned int i{ 0 }; i < count; ++i) {
+		aos[i].Destroyed = i != count - 1;
+		if (aos[i].Destroyed) soa.destroy(i);
+	}
+	soa.Destroyed.unset(count - 1);
+	start = BenchClock::now();
+	for (unsigned int p{ 0 }; p < PASSES; ++p) {
+		bool done = true;
+		for (const AosBrick& brick : aos) {
+			if (!brick.IsSolid && !brick.Destroyed) {
+				done = false;
+				break;
+			}
+		}
+		hits += done;
+	}
+	double aosComplete = nsPer(start, (unsigned long long)count * PASSES);
+
+	start = BenchClock::now();
+	for (unsigned int p{ 0 }; p < PASSES; ++p) {
+		hits += level.isCompleted();
+	}
+	double soaComplete = nsPer(start, (unsigned long long)count * PASSES);
+	benchSink = hits;
+
+	//bytes pulled through the cache per brick, worked out from the field sizes each scan
+	//reads rather than measured; a 64 byte line per 64 bytes read
+	double aosBytes = sizeof(AosBrick);
+	double soaCollideBytes = 2 * sizeof(glm::vec2) + 1.0 / 8.0;
+	double soaCompleteBytes = 2.0 / 8.0;
+
+	out << count << " bricks, " << PASSES << " passes\n";
+	out << std::setw(12) << "scan" << std::setw(10) << "layout" << std::setw(14) << "ns/brick" << std::setw(16) << "bytes/brick*" << std::setw(16) << "lines/1k*" << "\n";
+	auto row = [&](const char* scan, const char* layout, double ns, double bytes) {
+		out << std::setw(12) << scan << std::setw(10) << layout << std::setw(14) << std::fixed << std::setprecision(3) << ns
+			<< std::setw(16) << std::setprecision(2) << bytes << std::setw(16) << std::setprecision(1) << bytes * 1000.0 / 64.0 << "\n";
+	};
+	row("collision", "AoS", aosCollide, aosBytes);
+	row("collision", "SoA", soaCollide, soaCollideBytes);
+	row("completed", "AoS", aosComplete, aosBytes);
+	row("completed", "SoA", soaComplete, soaCompleteBytes);
+	out << "* derived from struct sizes, not measured; for real counts run this under\n"
+		<< "  perf stat -e cache-references,cache-misses BreakoutHeadless --bench bricks\n";
+}
+
+
+void benchLevelLoad(std::ostream& out) {
+	//one large level written out in both formats, then loaded over and over
+	const unsigned int COLUMNS{ 1024 }, ROWS{ 512 }, LOADS{ 20 };
+	const char* TEXT_FILE{ "bench_level.txt" };
+	const char* LEVEL_FILE{ "bench_level.lvl" };
+
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> code(0, 5);
+	std::vector<unsigned char> tiles(COLUMNS * ROWS);
+	{
+		std::ofstream text(TEXT_FILE);
+		for (unsigned int y{ 0 }; y < ROWS; ++y) {
+			for (unsigned int x{ 0 }; x < COLUMNS; ++x) {
+				tiles[y * COLUMNS + x] = static_cast<unsigned char>(code(rng));
+				text << int(tiles[y * COLUMNS + x]) << (x + 1 < COLUMNS ? " " : "\n");
+			}
+		}
+	}
+	if (!compileLevel(TEXT_FILE, LEVEL_FILE)) {
+		std::remove(TEXT_FILE);
+		return;
+	}
+
+	GameLevel level;
+	unsigned int bricks = 0;
+	auto start = BenchClock::now();
+	for (unsigned int i{ 0 }; i < LOADS; ++i) {
+		level.load(TEXT_FILE, 800, 300);
+		bricks += level.Bricks.size();
+	}
+	double textNs = nsPer(start, LOADS);
+
+	start = BenchClock::now();
+	for (unsigned int i{ 0 }; i < LOADS; ++i) {
+		level.load(LEVEL_FILE, 800, 300);
+		bricks += level.Bricks.size();
+	}
+	double compiledNs = nsPer(start, LOADS);
+	benchSink = bricks;
+
+	out << COLUMNS << "x" << ROWS << " tiles, " << level.Bricks.size() << " bricks, " << LOADS << " loads\n";
+	out << std::setw(10) << "format" << std::setw(14) << "ms/load" << std::setw(14) << "ns/tile" << "\n";
+	out << std::setw(10) << "text" << std::setw(14) << std::fixed << std::setprecision(3) << textNs / 1e6
+		<< std::setw(14) << std::setprecision(2) << textNs / (COLUMNS * ROWS) << "\n";
+	out << std::setw(10) << "compiled" << std::setw(14) << std::setprecision(3) << compiledNs / 1e6
+		<< std::setw(14) << std::setprecision(2) << compiledNs / (COLUMNS * ROWS) << "\n";
+	std::remove(TEXT_FILE);
+	std::remove(LEVEL_FILE);
+}
+
+
+void benchSweepKernel(std::ostream& out) {
+	//random balls swept against candidate lists the size a ball's query area produces
+	//(a handful of bricks) up to what a very fast ball in a dense level sees
+	const unsigned int BALLS{ 4096 };
+	const unsigned long long PAIRS{ 1ull << 24 };
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> pos(0.f, 400.f), vel(-600.f, 600.f), size(20.f, 60.f);
+	std::vector<glm::vec2> centers(BALLS), velocities(BALLS);
+	for (unsigned int i{ 0 }; i < BALLS; ++i) {
+		centers[i] = glm::vec2(pos(rng), pos(rng));
+		velocities[i] = glm::vec2(vel(rng), vel(rng));
+	}
+
+	out << std::setw(10) << "boxes" << std::setw(18) << "scalar Mpairs/s" << std::setw(18) << "simd Mpairs/s" << std::setw(10) << "speedup" << std::setw(12) << "mismatches" << "\n";
+	for (unsigned int count : { 4u, 16u, 64u, 256u }) {
+		SweepBoxes boxes;
+		for (unsigned int i{ 0 }; i < count; ++i) {
+			glm::vec2 min{ pos(rng), pos(rng) };
+			boxes.push(i, min, min + glm::vec2(size(rng), size(rng) / 2.f));
+		}
+		std::vector<float> scalarT(count), simdT(count);
+		unsigned long long calls = PAIRS / count;
+		unsigned int hits = 0;
+
+		auto start = BenchClock::now();
+		for (unsigned long long c{ 0 }; c < calls; ++c) {
+			unsigned int b = c % BALLS;
+			sweepCircleBoxesScalar(centers[b], velocities[b], 12.5f, 0.25f, boxes, scalarT.data());
+			hits += scalarT[c % count] >= 0.f;
+		}
+		double scalarNs = nsPer(start, calls * count);
+
+		start = BenchClock::now();
+		for (unsigned long long c{ 0 }; c < calls; ++c) {
+			unsigned int b = c % BALLS;
+			sweepCircleBoxes(centers[b], velocities[b], 12.5f, 0.25f, boxes, simdT.data());
+			hits += simdT[c % count] >= 0.f;
+		}
+		double simdNs = nsPer(start, calls * count);
+		benchSink = hits;
+
+		//both paths have to agree to the bit, or the kernel would change the simulation
+		unsigned int mismatches = 0;
+		for (unsigned int b{ 0 }; b < BALLS; ++b) {
+			sweepCircleBoxesScalar(centers[b], velocities[b], 12.5f, 0.25f, boxes, scalarT.data());
+			sweepCircleBoxes(centers[b], velocities[b], 12.5f, 0.25f, boxes, simdT.data());
+			for (unsigned int i{ 0 }; i < count; ++i) {
+				mismatches += std::memcmp(&scalarT[i], &simdT[i], sizeof(float)) != 0;
+			}
+		}
+
+		out << std::setw(10) << count << std::fixed << std::setprecision(1)
+			<< std::setw(18) << 1e3 / scalarNs << std::setw(18) << 1e3 / simdNs
+			<< std::setw(9) << std::setprecision(2) << scalarNs / simdNs << "x" << std::setw(12) << mismatches << "\n";
+	}
+#ifndef BREAKOUT_SSE
+	out << "(no SSE in this build, both columns are the scalar kernel)\n";
+#endif
+}
+
+
+void benchSnapshot(std::ostream& out) {
+	//a level big enough that copying its bricks shows: 256x128 tiles, 8 pages of bits
+	const unsigned int COLUMNS{ 256 }, ROWS{ 128 }, HISTORY{ 64 }, SNAPSHOTS{ 1 << 16 }, ROLLOUT{ 120 };
+	const float TICK{ 1.f / 120.f };
+	const char* LEVEL_FILE{ "bench_snapshot.lvl" };
+	if (!writeLevel(LEVEL_FILE, makeTileData(COLUMNS, ROWS), COLUMNS, ROWS)) {
+		return;
+	}
+	GameSimulation sim(800, 600);
+	sim.addLevel(LEVEL_FILE);
+	sim.Init();
+	sim.tick(INPUT_CONFIRM, TICK);
+	sim.tick(INPUT_LAUNCH, TICK);
+	//scripted paddle so the ball keeps hitting bricks between snapshots
+	auto input = [](unsigned int t) { return INPUT_LAUNCH | ((t / 90) % 2 ? INPUT_LEFT : INPUT_RIGHT); };
+
+	//a rollback buffer: one snapshot per tick, overwriting the oldest
+	std::vector<SimSnapshot> history(HISTORY);
+	double snapshotNs = 0, tickNs = 0;
+	for (unsigned int t{ 0 }; t < SNAPSHOTS; ++t) {
+		auto start = BenchClock::now();
+		sim.snapshot(history[t % HISTORY]);
+		snapshotNs += nsPer(start, 1);
+		start = BenchClock::now();
+		sim.tick(input(t), TICK);
+		tickNs += nsPer(start, 1);
+	}
+	//what the snapshot would cost if it copied the bits instead of sharing pages
+	const BrickStore& bricks = sim.Levels[sim.State.level].Bricks;
+	std::vector<unsigned long long> copy(bricks.SolidBits.size());
+	auto start = BenchClock::now();
+	for (unsigned int t{ 0 }; t < SNAPSHOTS; ++t) {
+		SimState state;
+		std::memcpy(&state, &sim.State, sizeof(SimState));
+		for (unsigned int w{ 0 }; w < copy.size(); ++w) {
+			copy[w] = bricks.Destroyed.word(w);
+		}
+		benchSink = static_cast<unsigned int>(copy[t % copy.size()]) + state.lives;
+	}
+	double deepNs = nsPer(start, SNAPSHOTS);
+
+	//rollouts: go back to the oldest snapshot and play it forward twice, both have to end
+	//in the same state or restore() missed something
+	SimSnapshot& oldest = history[SNAPSHOTS % HISTORY];
+	unsigned int mismatches = 0;
+	const unsigned int ROLLOUTS{ 256 };
+	start = BenchClock::now();
+	for (unsigned int r{ 0 }; r < ROLLOUTS; ++r) {
+		sim.restore(oldest);
+		for (unsigned int t{ 0 }; t < ROLLOUT; ++t) {
+			sim.tick(input(t + r), TICK);
+		}
+		unsigned long long first = hashState(sim);
+		sim.restore(oldest);
+		for (unsigned int t{ 0 }; t < ROLLOUT; ++t) {
+			sim.tick(input(t + r), TICK);
+		}
+		mismatches += hashState(sim) != first;
+	}
+	double rolloutNs = nsPer(start, ROLLOUTS * 2);
+
+	out << bricks.size() << " bricks, " << bricks.Destroyed.pageCount() << " pages, " << sizeof(SimState) << " byte state block\n";
+	out << std::fixed << std::setprecision(1);
+	out << std::setw(28) << "snapshot (shared pages)" << std::setw(12) << snapshotNs / SNAPSHOTS << " ns\n";
+	out << std::setw(28) << "snapshot (copied bits)" << std::setw(12) << deepNs << " ns\n";
+	out << std::setw(28) << "tick" << std::setw(12) << tickNs / SNAPSHOTS << " ns\n";
+	out << std::setw(28) << "restore + 120 ticks" << std::setw(12) << rolloutNs / 1e3 << " us, "
+		<< mismatches << "/" << ROLLOUTS << " rollouts diverged\n";
+	std::remove(LEVEL_FILE);
+}
+
+
+void benchParticles(std::ostream& out) {
+	//the budget is 1ms of CPU per frame for 100k particles; dead ones are replaced every
+	//frame so the pool stays full and spawning is part of the cost
+	const unsigned int LIVE{ 100000 }, FRAMES{ 600 };
+	const float FRAME{ 1.f / 120.f };
+	ParticleEmitter emitter{ glm::vec2(0.f, -1.f), 3.14159265f, 100.f, 60.f, 1.f, 0.5f, 5.f, glm::vec4(1.f), 0.f, 0.f };
+
+	out << LIVE << " particles, " << FRAMES << " frames\n";
+	out << std::setw(10) << "update" << std::setw(14) << "us/update" << std::setw(14) << "us/refill" << std::setw(14) << "ns/particle" << std::setw(12) << "in 1ms" << "\n";
+	for (int simd{ 0 }; simd < 2; ++simd) {
+		ParticleSystem particles(1 << 17);
+		particles.Gravity = 300.f;
+		particles.Drag = 1.5f;
+		particles.emit(emitter, glm::vec2(0.f), glm::vec2(800.f, 600.f), LIVE);
+
+		double updateNs = 0., refillNs = 0.;
+		unsigned long long updated = 0;
+		for (unsigned int f{ 0 }; f < FRAMES; ++f) {
+			updated += particles.size();
+			auto start = BenchClock::now();
+#ifdef BREAKOUT_SSE
+			if (simd) particles.updateSSE(FRAME);
+			else particles.updateScalar(FRAME);
+#else
+			particles.updateScalar(FRAME);
+#endif
+			updateNs += nsPer(start, 1);
+			start = BenchClock::now();
+			particles.emit(emitter, glm::vec2(0.f), glm::vec2(800.f, 600.f), LIVE - particles.size());
+			refillNs += nsPer(start, 1);
+		}
+		benchSink = particles.size();
+		double frameUs = (updateNs + refillNs) / FRAMES / 1e3;
+		out << std::setw(10) << (simd ? "simd" : "scalar") << std::fixed << std::setprecision(1)
+			<< std::setw(14) << updateNs / FRAMES / 1e3 << std::setw(14) << refillNs / FRAMES / 1e3
+			<< std::setw(14) << std::setprecision(2) << updateNs / updated
+			<< std::setw(12) << (frameUs <= 1000. ? "yes" : "no") << "\n";
+	}
+#ifndef BREAKOUT_SSE
+	out << "(no SSE in this build, both rows are the scalar update)\n";
+#endif
+}
+
+
+void benchLevelScaling(std::ostream& out, const char* csvFile) {
+	const unsigned int SIZES[]{ 100, 1000, 10000, 100000, 1000000 };
+	const unsigned int BALLS{ 8 }, TICKS{ 2000 }, CHECKS{ 200 };
+	const float SOLID_RATIO{ 0.1f };
+	const float TICK{ 1.f / 120.f };
+	const char* LEVEL_FILE{ "bench_scaling.lvl" };
+
+	std::ofstream csv;
+	if (csvFile) {
+		csv.open(csvFile);
+		csv << "bricks,pattern,solid_ratio,columns,rows,init_ms,lvl_load_ms,tick_ns,is_completed_ns,destroyed\n";
+	}
+	out << std::setw(9) << "bricks" << std::setw(9) << "pattern" << std::setw(11) << "grid"
+		<< std::setw(10) << "init ms" << std::setw(10) << "load ms" << std::setw(10) << "tick ns"
+		<< std::setw(14) << "completed ns" << std::setw(11) << "destroyed" << "\n";
+	for (unsigned int size : SIZES) {
+		for (int p{ 0 }; p < LEVEL_PATTERNS; ++p) {
+			LevelSpec spec{ size, SOLID_RATIO, static_cast<LevelPattern>(p), 1234 };
+			std::vector<unsigned char> tiles;
+			unsigned int columns, rows;
+			generateLevel(spec, tiles, columns, rows);
+
+			GameLevel level;
+			auto start = BenchClock::now();
+			level.init(tiles.data(), columns, rows, 800, 300);
+			double initNs = nsPer(start, 1);
+
+			double loadNs = 0.;
+			if (writeLevel(LEVEL_FILE, tiles, columns, rows)) {
+				GameLevel loaded;
+				start = BenchClock::now();
+				loaded.load(LEVEL_FILE, 800, 300);
+				loadNs = nsPer(start, 1);
+				std::remove(LEVEL_FILE);
+			}
+
+			//the autopilot keeps the game going; extra balls fanned out like --balls does
+			GameSimulation sim(800, 600);
+			sim.Levels.add("generated", level);
+			sim.Init(spec.seed);
+			sim.tick(INPUT_CONFIRM, TICK);
+			for (unsigned int b{ 1 }; b < BALLS; ++b) {
+				float angle = 3.14159265f * (0.1f + 0.8f * b / BALLS);
+				sim.spawnBall(glm::vec2(400.f, 450.f), glm::vec2(std::cos(angle), -std::sin(angle)) * 350.f);
+			}
+			unsigned int destroyed = 0;
+			start = BenchClock::now();
+			for (unsigned int t{ 0 }; t < TICKS; ++t) {
+				sim.tick(autopilotInput(sim), TICK);
+				for (const SimEvent& e : sim.Events) {
+					destroyed += e.type == EVENT_BRICK_DESTROYED;
+				}
+			}
+			double tickNs = nsPer(start, TICKS);
+
+			//isCompleted stops at the first brick still standing, so time the worst case:
+			//everything breakable gone but the very last brick
+			GameLevel& played = sim.Levels[0];
+			for (unsigned int b{ 0 }; b + 1 < played.Bricks.size(); ++b) {
+				played.Bricks.destroy(b);
+			}
+			unsigned int completed = 0;
+			start = BenchClock::now();
+			for (unsigned int c{ 0 }; c < CHECKS; ++c) {
+				completed += played.isCompleted();
+			}
+			double completedNs = nsPer(start, CHECKS);
+			benchSink = completed;
+
+			unsigned int bricks = level.Bricks.size();
+			std::string grid = std::to_string(columns) + "x" + std::to_string(rows);
+			out << std::setw(9) << bricks << std::setw(9) << levelPatternName(spec.pattern) << std::setw(11) << grid
+				<< std::fixed << std::setprecision(3) << std::setw(10) << initNs / 1e6 << std::setw(10) << loadNs / 1e6
+				<< std::setprecision(0) << std::setw(10) << tickNs << std::setw(14) << completedNs << std::setw(11) << destroyed << "\n";
+			if (csv) {
+				csv << bricks << "," << levelPatternName(spec.pattern) << "," << SOLID_RATIO << "," << columns << "," << rows << ","
+					<< initNs / 1e6 << "," << loadNs / 1e6 << "," << tickNs << "," << completedNs << "," << destroyed << "\n";
+			}
+		}
+	}
+}
+
+
+//a mono 16-bit sine WAV, for the audio benchmark's sound bank
+static void writeToneWav(const char* file, float frequency, float seconds) {
+	unsigned int frames = static_cast<unsigned int>(seconds * AUDIO_SAMPLE_RATE);
+	std::vector<short> samples(frames);
+	for (unsigned int i{ 0 }; i < frames; ++i) {
+		samples[i] = static_cast<short>(std::sin(6.2831853f * frequency * i / AUDIO_SAMPLE_RATE) * 8000.f);
+	}
+	std::ofstream out(file, std::ios::binary);
+	writeWavHeader(out, frames, 1);
+	writeWavSamples(out, samples.data(), samples.size());
+}
+
+void benchAudio(std::ostream& out, const char* wavFile) {
+	const char* TONES[]{ "bench_tone0.wav", "bench_tone1.wav", "bench_tone2.wav", "bench_tone3.wav" };
+	for (unsigned int i{ 0 }; i < 4; ++i) {
+		writeToneWav(TONES[i], 220.f * (i + 1), 0.1f + 0.1f * i);
+	}
+
+	//raw queue throughput, one thread each side, yielding on full/empty so this also
+	//finishes on a single core
+	{
+		const unsigned int COMMANDS{ 10000000 };
+		SpscQueue<SoundCommand, SOUND_QUEUE_SIZE> queue;
+		unsigned long long sum = 0;
+		auto start = BenchClock::now();
+		std::thread consumer([&]() {
+			SoundCommand command;
+			for (unsigned int n{ 0 }; n < COMMANDS; ) {
+				if (queue.pop(command)) {
+					sum += command.sound;
+					n++;
+				}
+				else {
+					std::this_thread::yield();
+				}
+			}
+		});
+		for (unsigned int n{ 0 }; n < COMMANDS; ) {
+			if (queue.push(SoundCommand{ n & 3, 1.f })) {
+				n++;
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+		consumer.join();
+		double ns = nsPer(start, COMMANDS);
+		benchSink = static_cast<unsigned int>(sum);
+		out << "spsc queue: " << std::fixed << std::setprecision(1) << ns << " ns/command, " << 1e3 / ns << "M commands/s\n";
+	}
+
+	//audio thread work per period with every voice busy and more sounds arriving than
+	//there are voices, run inline so it's just the cost of draining and mixing
+	{
+		const unsigned int PERIODS{ 4000 }, SOUNDS_PER_PERIOD{ 40 };
+		AudioSystem audio(new MixerAudioBackend(wavFile));
+		SoundHandle sounds[4];
+		for (unsigned int i{ 0 }; i < 4; ++i) {
+			sounds[i] = audio.loadSound(TONES[i]);
+		}
+		for (unsigned int p{ 0 }; p < PERIODS; ++p) {
+			for (unsigned int s{ 0 }; s < SOUNDS_PER_PERIOD; ++s) {
+				audio.play(sounds[(p + s) & 3], 0.1f);
+			}
+			audio.process();
+		}
+		AudioSystem::Stats stats = audio.stats();
+		double periodSeconds = (double)AUDIO_PERIOD_FRAMES / AUDIO_SAMPLE_RATE;
+		out << "mixer, " << MAX_VOICES << " voices: " << std::setprecision(2) << stats.busySeconds / stats.periods * 1e6 << " us/period ("
+			<< 100.0 * stats.busySeconds / (stats.periods * periodSeconds) << "% of real time), "
+			<< stats.played << " played, " << stats.stolen << " stolen";
+		out << (wavFile ? std::string(", written to ") + wavFile : std::string()) << "\n";
+	}
+
+	//the real arrangement: the game thread pushing bursts every tick, the audio thread draining
+	{
+		const double SECONDS{ 0.5 };
+		AudioSystem audio(new MixerAudioBackend());
+		SoundHandle sounds[4];
+		for (unsigned int i{ 0 }; i < 4; ++i) {
+			sounds[i] = audio.loadSound(TONES[i]);
+		}
+		audio.start();
+		unsigned long long pushed = 0;
+		double pushNs = 0.0;
+		auto start = BenchClock::now();
+		auto next = start;
+		for (unsigned int tick{ 0 }; tick < SECONDS * 120; ++tick) {
+			auto pushStart = BenchClock::now();
+			for (unsigned int s{ 0 }; s < 8; ++s) {
+				audio.play(sounds[(tick + s) & 3], 0.1f);
+				pushed++;
+			}
+			pushNs += std::chrono::duration<double, std::nano>(BenchClock::now() - pushStart).count();
+			next += std::chrono::microseconds(8333);
+			std::this_thread::sleep_until(next);
+		}
+		audio.stop();
+		AudioSystem::Stats stats = audio.stats();
+		out << "threaded, 8 sounds/tick at 120Hz: " << std::setprecision(1) << pushNs / pushed << " ns/play on the game thread, "
+			<< stats.played << "/" << pushed << " played, " << stats.stolen << " stolen, " << stats.dropped << " dropped\n";
+	}
+
+	for (const char* tone : TONES) {
+		std::remove(tone);
+	}
+}
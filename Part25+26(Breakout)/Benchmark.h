@@ -0,0 +1,35 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include <ostream>
+#include <vector>
+
+//simulation-side micro benchmarks, run with BreakoutHeadless --bench <name>;
+//none of these touch GL so they can run on build machines
+
+//rows x columns of breakable tiles, laid out for GameLevel::init
+std::vector<unsigned char> makeTileData(unsigned int columns, unsigned int rows, unsigned char tileCode = 2);
+
+//brute-force loop over every brick vs the grid query, at increasing brick counts
+void benchBroadphase(std::ostream& out);
+//full-level scans over the old GameObject-per-brick layout vs BrickStore; the timings are
+//measured, the bytes and cache lines per brick next to them are worked out from struct sizes
+void benchBrickLayout(std::ostream& out);
+//GameLevel::load from the text format vs a compiled .lvl
+void benchLevelLoad(std::ostream& out);
+//ball-vs-brick swept tests per second, scalar kernel vs the SSE one
+void benchSweepKernel(std::ostream& out);
+//snapshot()/restore() cost on a big level vs copying the brick bits outright, and
+//restore-and-replay rollouts checked against each other
+void benchSnapshot(std::ostream& out);
+//particle update cost with 100k live particles, topped back up every frame, scalar vs SSE
+void benchParticles(std::ostream& out);
+//generated levels from 100 to 1M bricks in every pattern: GameLevel::init, .lvl load,
+//simulation tick with 8 balls and worst-case isCompleted cost per size. Drawing is timed
+//by Breakout --bench scaling, which needs GL. The table goes to out; the
+//same numbers go to csvFile as CSV if one is given
+void benchLevelScaling(std::ostream& out, const char* csvFile = nullptr);
+//SPSC queue throughput, mixer cost per period and the threaded play path; wavFile, if
+//given, gets the mixer's output
+void benchAudio(std::ostream& out, const char* wavFile = nullptr);
+
+#endif
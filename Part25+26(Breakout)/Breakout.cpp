@@ -1,91 +1,303 @@
-#include <iostream>
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
-
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include "Game.h"
-#include "ResourceManager.h"
-
-//settings
-int SCR_WIDTH{ 800 };
-int SCR_HEIGHT{ 600 };
-Game Breakout(SCR_WIDTH, SCR_HEIGHT);
-
-void framebuffer_scall(GLFWwindow* window, int w, int h) {
-    glViewport(0, 0, w, h);
-    SCR_WIDTH = w;
-    SCR_HEIGHT = h;
-}
-
-void key_scall(GLFWwindow* window, int key, int scancode, int action, int mode)
-{
-    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-    if (key >= 0 && key < 1024)
-    {
-        if (action == GLFW_PRESS)
-            Breakout.keys[key] = true;
-        else if (action == GLFW_RELEASE)
-            Breakout.keys[key] = false;
-    }
-}
-
-int main()
-{
-    //init openGL
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
-
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Breakout", NULL, NULL);
-    if (window == NULL) {
-        std::cout << "ERROR: Failed to load window!\n";
-        return -1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, &framebuffer_scall);
-    glfwSetKeyCallback(window, &key_scall);
-
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cout << "ERROR: Failed to load glad!\n";
-        return -1;
-    }
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    Breakout.Init();
-
-    float deltaTime = 0.f;
-    float lastFrame = 0.f;
-
-    //render loop
-    while (!glfwWindowShouldClose(window)) {
-        float currentTime = (float)glfwGetTime();
-        deltaTime = currentTime - lastFrame;
-        lastFrame = currentTime;
-        glfwPollEvents();
-
-        Breakout.processInput(deltaTime);
-
-        Breakout.update(deltaTime);
-
-        glClearColor(0.f, 0.f, 0.f, 1.0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        Breakout.render();
-
-        glfwSwapBuffers(window);
-    }
-
-    ResourceManager::Clear();
-    glfwTerminate();
-    return 0;
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Game.h"
+#include "ResourceManager.h"
+#include "PostProcessor.h"
+#include "LevelGenerator.h"
+#include "ThreadPool.h"
+#include <fstream>
+
+//settings
+int SCR_WIDTH{ 800 };
+int SCR_HEIGHT{ 600 };
+
+//the simulation always advances in fixed ticks, rendering interpolates between them
+double SIM_TICK_RATE{ 120.0 };
+const int MAX_SUBSTEPS{ 8 };
+
+Game Breakout(SCR_WIDTH, SCR_HEIGHT);
+
+void framebuffer_scall(GLFWwindow* window, int w, int h) {
+    glViewport(0, 0, w, h);
+    SCR_WIDTH = w;
+    SCR_HEIGHT = h;
+    Breakout.resize(w, h);
+}
+
+void key_scall(GLFWwindow* window, int key, int scancode, int action, int mode)
+{
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+    if (key >= 0 && key < 1024)
+    {
+        if (action == GLFW_PRESS)
+            Breakout.keys[key] = true;
+        else if (action == GLFW_RELEASE)
+            Breakout.keys[key] = false;
+    }
+}
+
+//GPU time of the post-processing composite at 1080p and 4K, with no effects and with all
+//of them; drawn into offscreen targets so the window size doesn't matter
+void benchPostProcessor()
+{
+    const unsigned int FRAMES{ 300 };
+    const unsigned int SIZES[][2]{ { 1920, 1080 }, { 3840, 2160 } };
+    Shader& shader = ResourceManager::GetShader(ResourceManager::LoadShader("shaders/post.vs", "shaders/post.fs", NULL, "post"));
+
+    std::cout << "resolution      effects       ms/composite\n";
+    for (const auto& size : SIZES) {
+        PostProcessor post(shader, size[0], size[1]);
+        unsigned int target, targetTexture;
+        glGenFramebuffers(1, &target);
+        glGenTextures(1, &targetTexture);
+        glBindTexture(GL_TEXTURE_2D, targetTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size[0], size[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targetTexture, 0);
+
+        for (int allEffects{ 0 }; allEffects < 2; ++allEffects) {
+            post.Shake = allEffects ? 4.f : 0.f;
+            post.Confuse = post.Chaos = allEffects != 0;
+            post.Vignette = allEffects ? 0.6f : 0.f;
+            for (unsigned int f{ 0 }; f < 2 * FRAMES; ++f) {
+                //first half warms up
+                if (f == FRAMES) {
+                    post.resetTimings();
+                }
+                post.begin();
+                post.end();
+                post.composite(f / 60.f, target);
+            }
+            post.collectTimings();
+            std::cout << size[0] << "x" << size[1] << (allEffects ? "       all          " : "       none         ")
+                << post.compositeMilliseconds() << "\n";
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &target);
+        glDeleteTextures(1, &targetTexture);
+    }
+}
+
+//per-frame brick drawing cost on generated levels from 100 to 1M bricks, the GL half of
+//BreakoutHeadless --bench scaling: every brick drawn each frame, then through the cached
+//level layer. The table goes to stdout and, given a file, CSV too
+void benchLevelDraw(const char* csvFile)
+{
+    const unsigned int SIZES[]{ 100, 1000, 10000, 100000, 1000000 };
+    const unsigned int FRAMES{ 20 };
+    std::ofstream csv;
+    if (csvFile) {
+        csv.open(csvFile);
+        csv << "bricks,pattern,solid_ratio,draw_ms,cached_ms\n";
+    }
+    std::cout << "bricks   pattern   draw ms   cached ms\n";
+    for (unsigned int size : SIZES) {
+        for (int p{ 0 }; p < LEVEL_PATTERNS; ++p) {
+            LevelSpec spec{ size, 0.1f, static_cast<LevelPattern>(p), 1234 };
+            std::vector<unsigned char> tiles;
+            unsigned int columns, rows;
+            generateLevel(spec, tiles, columns, rows);
+            GameLevel level;
+            level.init(tiles.data(), columns, rows, SCR_WIDTH, SCR_HEIGHT / 2);
+            //one untimed frame so buffer growth isn't counted
+            Breakout.timeLevelDraw(level, 1);
+            double ms = Breakout.timeLevelDraw(level, FRAMES);
+            double cachedMs = Breakout.timeLevelDraw(level, FRAMES, true);
+            std::cout << level.Bricks.size() << "   " << levelPatternName(spec.pattern) << "   " << ms << "   " << cachedMs << "\n";
+            if (csv) {
+                csv << level.Bricks.size() << "," << levelPatternName(spec.pattern) << "," << spec.solidRatio << "," << ms << "," << cachedMs << "\n";
+            }
+        }
+    }
+}
+
+//loads the given images one after another and then as a batch decoded on a thread pool,
+//a few times each, and reports how long until they're all uploaded (glFinish). This is the
+//loading on its own; --time-startup with --startup-textures gives the first frame
+void benchTextureLoading(const std::vector<TextureRequest>& images)
+{
+    const unsigned int RUNS{ 3 };
+    ThreadPool pool;
+    std::cout << images.size() << " images, " << pool.size() << " decode threads\n";
+    for (int parallel{ 0 }; parallel < 2; ++parallel) {
+        double total = 0.0;
+        for (unsigned int run{ 0 }; run < RUNS; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            ResourceManager::LoadTextures(images, parallel ? &pool : nullptr);
+            glFinish();
+            total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            ResourceManager::Clear();
+        }
+        std::cout << (parallel ? "batched load to GPU:  " : "serial load to GPU:   ") << total / RUNS << " ms\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    //--record file saves the session's input for BreakoutHeadless --replay
+    const char* recordFile{ nullptr };
+    //--bench post times the post-processing pass, --bench scaling [out.csv] the brick
+    //drawing on generated levels; both exit afterwards
+    bool benchPost{ false };
+    bool benchScaling{ false };
+    const char* scalingCsv{ nullptr };
+    //--bench textures image... times loading those images serially and batched
+    std::vector<TextureRequest> benchTextures;
+    //--time-startup reports when the first frame is on screen; --startup-textures image...
+    //makes Init load those too, batched on decode threads unless --serial-textures is given
+    bool timeStartup{ false };
+    std::vector<TextureRequest> startupTextures;
+    bool serialTextures{ false };
+    for (int i{ 1 }; i < argc; ++i) {
+        if (std::string(argv[i]) == "--tickrate" && i + 1 < argc) {
+            SIM_TICK_RATE = std::max(1.0, std::atof(argv[++i]));
+        }
+        else if (std::string(argv[i]) == "--record" && i + 1 < argc) {
+            recordFile = argv[++i];
+        }
+        else if (std::string(argv[i]) == "--bench" && i + 1 < argc && std::string(argv[i + 1]) == "post") {
+            benchPost = true;
+            i++;
+        }
+        else if (std::string(argv[i]) == "--bench" && i + 1 < argc && std::string(argv[i + 1]) == "textures") {
+            i++;
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                std::string file = argv[++i];
+                benchTextures.push_back(TextureRequest{ file, file.size() > 4 && file.compare(file.size() - 4, 4, ".png") == 0, file });
+            }
+        }
+        else if (std::string(argv[i]) == "--time-startup") {
+            timeStartup = true;
+        }
+        else if (std::string(argv[i]) == "--startup-textures") {
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                std::string file = argv[++i];
+                startupTextures.push_back(TextureRequest{ file, file.size() > 4 && file.compare(file.size() - 4, 4, ".png") == 0, file });
+            }
+        }
+        else if (std::string(argv[i]) == "--serial-textures") {
+            serialTextures = true;
+        }
+        else if (std::string(argv[i]) == "--bench" && i + 1 < argc && std::string(argv[i + 1]) == "scaling") {
+            benchScaling = true;
+            i++;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                scalingCsv = argv[++i];
+            }
+        }
+    }
+    const double SIM_TICK{ 1.0 / SIM_TICK_RATE };
+
+    //init openGL
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    if (benchPost || benchScaling || !benchTextures.empty()) {
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    }
+
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Breakout", NULL, NULL);
+    if (window == NULL) {
+        std::cout << "ERROR: Failed to load window!\n";
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, &framebuffer_scall);
+    glfwSetKeyCallback(window, &key_scall);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "ERROR: Failed to load glad!\n";
+        return -1;
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    if (benchPost) {
+        benchPostProcessor();
+        ResourceManager::Clear();
+        glfwTerminate();
+        return 0;
+    }
+    if (!benchTextures.empty()) {
+        benchTextureLoading(benchTextures);
+        glfwTerminate();
+        return 0;
+    }
+
+    Breakout.Init(startupTextures, serialTextures);
+    if (benchScaling) {
+        benchLevelDraw(scalingCsv);
+        ResourceManager::Clear();
+        glfwTerminate();
+        return 0;
+    }
+    //on high-DPI screens the framebuffer is bigger than the window
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    Breakout.resize(framebufferWidth, framebufferHeight);
+    if (recordFile) {
+        Breakout.Recorder.begin(Breakout.sim, (float)SIM_TICK);
+    }
+
+    double accumulator = 0.0;
+    double lastFrame = glfwGetTime();
+
+    //render loop
+    while (!glfwWindowShouldClose(window)) {
+        double currentTime = glfwGetTime();
+        accumulator += currentTime - lastFrame;
+        lastFrame = currentTime;
+        glfwPollEvents();
+
+        //run as many whole ticks as fit into the elapsed time, but never more than
+        //MAX_SUBSTEPS so a long frame can't snowball into an even longer one
+        int substeps = 0;
+        while (accumulator >= SIM_TICK && substeps < MAX_SUBSTEPS) {
+            Breakout.tick((float)SIM_TICK);
+            accumulator -= SIM_TICK;
+            substeps++;
+        }
+        if (accumulator >= SIM_TICK) {
+            accumulator = std::fmod(accumulator, SIM_TICK);
+        }
+
+        //no clear here, the post-processing pass covers every pixel
+        Breakout.render((float)(accumulator / SIM_TICK));
+
+        glfwSwapBuffers(window);
+        if (timeStartup) {
+            glFinish();
+            std::cout << "first frame after " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms ("
+                << startupTextures.size() + 1 << " textures, " << (startupTextures.empty() || serialTextures ? "serial" : "batched") << ")\n";
+            timeStartup = false;
+        }
+    }
+
+    if (recordFile) {
+        Breakout.Recorder.save(recordFile, Breakout.sim);
+    }
+
+    ResourceManager::Clear();
+    glfwTerminate();
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,351 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+
+#include "GameSimulation.h"
+#include "Benchmark.h"
+#include "TextureAtlas.h"
+#include "LevelFile.h"
+#include "InputRecording.h"
+#include "BatchRunner.h"
+#include "LevelGenerator.h"
+
+//entry point for the simulation-only build: links GameSimulation, SweepKernel, GameLevel, LevelFile,
+//LevelCatalog, LevelGenerator, InputRecording, BatchRunner, ThreadPool, ParticleSystem, game_object,
+//Benchmark, AudioSystem, TextureAtlas and stb_image and nothing else, so it
+//runs without GL or audio
+
+const float SIM_TICK{ 1.f / 120.f };
+
+//re-runs a recorded session, checks it ends up in the recorded state and reports how
+//long the ticks took; false on a hash mismatch or a file that won't load
+bool replaySession(const char* file) {
+	InputRecording recording;
+	if (!recording.load(file)) {
+		return false;
+	}
+	GameSimulation sim(recording.width, recording.height);
+	recording.setup(sim);
+	//load every level before timing so the histogram is just ticks
+	for (unsigned int i{ 0 }; i < sim.Levels.size(); ++i) {
+		sim.Levels[i];
+	}
+
+	//log2 buckets of ns per tick, from under 32ns up to 64us and over
+	const int FIRST_BUCKET{ 5 }, BUCKETS{ 13 };
+	unsigned long long histogram[BUCKETS]{};
+	std::vector<unsigned int> tickNs(recording.ticks);
+	InputPlayer player(recording);
+	auto start = std::chrono::steady_clock::now();
+	auto last = start;
+	for (unsigned long long t{ 0 }; t < recording.ticks; ++t) {
+		sim.tick(player.next(), recording.tick);
+		auto now = std::chrono::steady_clock::now();
+		tickNs[t] = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count());
+		last = now;
+	}
+	double seconds = std::chrono::duration<double>(last - start).count();
+	for (unsigned int ns : tickNs) {
+		int bucket = 0;
+		while (bucket < BUCKETS - 1 && ns >= (1u << (FIRST_BUCKET + bucket))) {
+			bucket++;
+		}
+		histogram[bucket]++;
+	}
+
+	unsigned long long hash = hashState(sim);
+	bool match = hash == recording.finalHash;
+	std::cout << file << ": " << recording.ticks << " ticks, " << std::fixed << std::setprecision(1)
+		<< seconds * 1e9 / std::max(1ull, recording.ticks) << " ns/tick, final state "
+		<< (match ? "matches" : "DOES NOT MATCH") << " (" << std::hex << hash << std::dec << ")\n";
+	for (int b{ 0 }; b < BUCKETS; ++b) {
+		if (histogram[b] == 0) continue;
+		std::string range = b == 0 ? "< " + std::to_string(1u << FIRST_BUCKET)
+			: b == BUCKETS - 1 ? ">= " + std::to_string(1u << (FIRST_BUCKET + b - 1))
+			: std::to_string(1u << (FIRST_BUCKET + b - 1)) + "-" + std::to_string((1u << (FIRST_BUCKET + b)) - 1);
+		std::cout << std::setw(16) << range << " ns " << std::setw(10) << histogram[b] << "\n";
+	}
+	if (!tickNs.empty()) {
+		std::sort(tickNs.begin(), tickNs.end());
+		std::cout << "  p50 " << tickNs[tickNs.size() / 2] << " ns, p99 " << tickNs[tickNs.size() * 99 / 100]
+			<< " ns, max " << tickNs.back() << " ns\n";
+	}
+	return match;
+}
+
+//plays the same batch of games on 1, 2, 4... up to maxThreads threads, prints the scaling
+//curve, then how each level played out; false if any thread count changed a game's result
+bool runBatch(const std::vector<std::string>& levels, unsigned int gameCount, unsigned long long maxTicks, unsigned int maxThreads) {
+	BatchRunner runner(800, 600);
+	for (const std::string& file : levels) {
+		if (!runner.addLevel(file)) {
+			std::cout << "ERROR: Failed to load level " << file << "\n";
+			return false;
+		}
+	}
+	//every level gets the same number of games, alternating autopilot and scripted input
+	std::vector<BatchGame> games(gameCount);
+	for (unsigned int i{ 0 }; i < gameCount; ++i) {
+		unsigned int round = i / runner.levelCount();
+		games[i] = BatchGame{ i % runner.levelCount(), i, round % 2 ? BATCH_SCRIPTED : BATCH_AUTOPILOT };
+	}
+
+	std::vector<unsigned int> threadCounts;
+	for (unsigned int n{ 1 }; n < maxThreads; n *= 2) {
+		threadCounts.push_back(n);
+	}
+	threadCounts.push_back(maxThreads);
+
+	std::cout << gameCount << " games on " << runner.levelCount() << " levels, at most " << maxTicks << " ticks each\n";
+	std::cout << std::setw(8) << "threads" << std::setw(14) << "Mticks/s" << std::setw(10) << "speedup"
+		<< std::setw(12) << "efficiency" << std::setw(10) << "steals" << "\n";
+	std::vector<BatchResult> first;
+	double baseline = 0.;
+	bool consistent = true;
+	for (unsigned int threads : threadCounts) {
+		ThreadPool pool(threads);
+		auto start = std::chrono::steady_clock::now();
+		std::vector<BatchResult> results = runner.run(pool, games, maxTicks);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		unsigned long long ticks = 0;
+		for (const BatchResult& r : results) {
+			ticks += r.ticks;
+		}
+		double rate = ticks / seconds;
+		if (first.empty()) {
+			first = results;
+			baseline = rate;
+		}
+		for (size_t i{ 0 }; i < results.size(); ++i) {
+			consistent = consistent && results[i].hash == first[i].hash && results[i].ticks == first[i].ticks;
+		}
+		std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2) << std::setw(14) << rate / 1e6
+			<< std::setw(9) << rate / baseline << "x" << std::setw(11) << std::setprecision(0) << 100. * rate / baseline / threads << "%"
+			<< std::setw(10) << pool.stats().stolen << "\n";
+	}
+	if (!consistent) {
+		std::cout << "ERROR: games played out differently on different thread counts\n";
+	}
+
+	std::cout << std::setw(24) << "level" << std::setw(11) << "input" << std::setw(8) << "games" << std::setw(8) << "won"
+		<< std::setw(12) << "avg ticks" << std::setw(12) << "avg bricks" << std::setw(12) << "avg lost" << "\n";
+	for (unsigned int level{ 0 }; level < runner.levelCount(); ++level) {
+		for (BatchInput input : { BATCH_AUTOPILOT, BATCH_SCRIPTED }) {
+			unsigned int played = 0, won = 0;
+			double ticks = 0., bricks = 0., lost = 0.;
+			for (size_t i{ 0 }; i < games.size(); ++i) {
+				if (games[i].level != level || games[i].input != input) continue;
+				played++;
+				won += first[i].won;
+				ticks += first[i].ticks;
+				bricks += first[i].bricksDestroyed;
+				lost += first[i].livesLost;
+			}
+			if (played == 0) continue;
+			std::cout << std::setw(24) << runner.levelFile(level) << std::setw(11) << (input == BATCH_AUTOPILOT ? "autopilot" : "scripted")
+				<< std::setw(8) << played << std::setw(7) << std::setprecision(0) << 100. * won / played << "%"
+				<< std::setw(12) << ticks / played << std::setw(12) << std::setprecision(1) << bricks / played
+				<< std::setw(12) << std::setprecision(2) << lost / played << "\n";
+		}
+	}
+	return consistent;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned long long ticks{ 1000000 };
+	unsigned int balls{ 1 };
+	std::vector<std::string> levels;
+	std::vector<const char*> replays;
+	const char* recordFile{ nullptr };
+	unsigned int batchGames{ 0 };
+	unsigned int threads{ std::max(1u, std::thread::hardware_concurrency()) };
+	bool ticksGiven{ false };
+	for (int i{ 1 }; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--ticks" && i + 1 < argc) {
+			ticks = std::strtoull(argv[++i], nullptr, 10);
+			ticksGiven = true;
+		}
+		else if (arg == "--balls" && i + 1 < argc) {
+			balls = std::atoi(argv[++i]);
+		}
+		else if (arg == "--batch" && i + 1 < argc) {
+			batchGames = std::atoi(argv[++i]);
+		}
+		else if (arg == "--threads" && i + 1 < argc) {
+			threads = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "--record" && i + 1 < argc) {
+			recordFile = argv[++i];
+		}
+		else if (arg == "--replay" && i + 1 < argc) {
+			replays.push_back(argv[++i]);
+		}
+		else if (arg == "--level" && i + 1 < argc) {
+			levels.push_back(argv[++i]);
+		}
+		else if (arg == "--build-atlas" && i + 1 < argc) {
+			//--build-atlas out.atlas [--padding N] name=image ...
+			const char* out = argv[++i];
+			unsigned int padding = 4;
+			std::vector<AtlasSource> sources;
+			for (++i; i < argc; ++i) {
+				std::string source = argv[i];
+				size_t eq = source.find('=');
+				if (source == "--padding" && i + 1 < argc) {
+					padding = std::atoi(argv[++i]);
+				}
+				else if (eq != std::string::npos) {
+					sources.push_back(AtlasSource{ source.substr(0, eq), source.substr(eq + 1) });
+				}
+			}
+			AtlasImage atlas;
+			if (!packAtlas(sources, padding, atlas) || !writeAtlas(out, atlas)) {
+				return -1;
+			}
+			std::cout << atlas.rects.size() << " sprites packed into " << atlas.width << "x" << atlas.height << " " << out << "\n";
+			return 0;
+		}
+		else if (arg == "--compile-level" && i + 2 < argc) {
+			//--compile-level in.txt out.lvl
+			const char* in = argv[++i];
+			const char* out = argv[++i];
+			if (!compileLevel(in, out)) {
+				return -1;
+			}
+			std::cout << "compiled " << in << " to " << out << "\n";
+			return 0;
+		}
+		else if (arg == "--generate-level" && i + 2 < argc) {
+			//--generate-level out.lvl bricks [--solid ratio] [--pattern full|checker|random|pyramid] [--seed N]
+			const char* out = argv[++i];
+			LevelSpec spec{ static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)), 0.1f, PATTERN_FULL, 1 };
+			for (++i; i + 1 < argc; i += 2) {
+				std::string option = argv[i];
+				if (option == "--solid") {
+					spec.solidRatio = static_cast<float>(std::atof(argv[i + 1]));
+				}
+				else if (option == "--seed") {
+					spec.seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+				}
+				else if (option != "--pattern" || !parseLevelPattern(argv[i + 1], spec.pattern)) {
+					std::cout << "ERROR: Unknown level option " << option << " " << argv[i + 1] << "\n";
+					return -1;
+				}
+			}
+			std::vector<unsigned char> tiles;
+			unsigned int columns, rows;
+			generateLevel(spec, tiles, columns, rows);
+			if (!writeLevel(out, tiles, columns, rows)) {
+				return -1;
+			}
+			unsigned int bricks = static_cast<unsigned int>(tiles.size() - std::count(tiles.begin(), tiles.end(), 0));
+			std::cout << bricks << " bricks on a " << columns << "x" << rows << " grid written to " << out << "\n";
+			return 0;
+		}
+		else if (arg == "--bench" && i + 1 < argc) {
+			std::string name = argv[++i];
+			if (name == "broadphase") {
+				benchBroadphase(std::cout);
+			}
+			else if (name == "bricks") {
+				benchBrickLayout(std::cout);
+			}
+			else if (name == "levels") {
+				benchLevelLoad(std::cout);
+			}
+			else if (name == "sweep") {
+				benchSweepKernel(std::cout);
+			}
+			else if (name == "snapshot") {
+				benchSnapshot(std::cout);
+			}
+			else if (name == "particles") {
+				benchParticles(std::cout);
+			}
+			else if (name == "scaling") {
+				//--bench scaling [out.csv]
+				benchLevelScaling(std::cout, i + 1 < argc ? argv[i + 1] : nullptr);
+			}
+			else if (name == "audio") {
+				//--bench audio [out.wav]
+				benchAudio(std::cout, i + 1 < argc ? argv[i + 1] : nullptr);
+			}
+			else {
+				std::cout << "ERROR: Unknown benchmark " << name << "\n";
+				return -1;
+			}
+			return 0;
+		}
+	}
+	if (!replays.empty()) {
+		bool allMatch = true;
+		for (const char* file : replays) {
+			allMatch = replaySession(file) && allMatch;
+		}
+		return allMatch ? 0 : 1;
+	}
+	if (recordFile && balls > 1) {
+		std::cout << "ERROR: --record only records input, so it can't be combined with --balls\n";
+		return -1;
+	}
+	if (levels.empty()) {
+		levels = { "level/one.txt", "level/two.txt", "level/three.txt", "level/four.txt" };
+	}
+	if (batchGames > 0) {
+		//--batch N [--threads N] [--ticks per game, five minutes of play by default]
+		return runBatch(levels, batchGames, ticksGiven ? ticks : 36000, threads) ? 0 : 1;
+	}
+
+	GameSimulation sim(800, 600);
+	for (const std::string& file : levels) {
+		//load up front so file errors show up before the timed run
+		if (sim.Levels[sim.addLevel(file.c_str())].Bricks.empty()) {
+			std::cout << "ERROR: Failed to load level " << file << "\n";
+			return -1;
+		}
+	}
+	sim.Init();
+	//stress mode: extra balls fanned out upwards from the middle of the screen
+	for (unsigned int b{ 1 }; b < balls; ++b) {
+		float angle = 3.14159265f * (0.1f + 0.8f * b / balls);
+		sim.spawnBall(glm::vec2(sim.width / 2.f, sim.height * 0.75f), glm::vec2(std::cos(angle), -std::sin(angle)) * 350.f);
+	}
+
+	InputRecorder recorder;
+	if (recordFile) {
+		recorder.begin(sim, SIM_TICK);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	unsigned long long bricksDestroyed = 0;
+	unsigned long long ballTicks = 0;
+	for (unsigned long long t{ 0 }; t < ticks; ++t) {
+		unsigned int input = autopilotInput(sim);
+		if (recordFile) {
+			recorder.record(input);
+		}
+		sim.tick(input, SIM_TICK);
+		ballTicks += sim.State.Balls.Count;
+		for (const SimEvent& e : sim.Events) {
+			if (e.type == EVENT_BRICK_DESTROYED) bricksDestroyed++;
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << ticks << " ticks in " << seconds << "s ("
+		<< static_cast<unsigned long long>(ticks / seconds) << " ticks/s), "
+		<< bricksDestroyed << " bricks destroyed, " << static_cast<double>(ballTicks) / ticks << " balls in play on average\n";
+	if (recordFile && !recorder.save(recordFile, sim)) {
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,73 @@
+#ifndef FIXED_POOL_H
+#define FIXED_POOL_H
+
+//a handle stays valid until its item is released; after that the slot's generation has
+//moved on and get() turns the stale handle down instead of handing out the new occupant
+struct PoolHandle {
+	unsigned int Index;
+	unsigned int Generation;
+};
+
+//Capacity items in place, no allocation after construction, and plain arrays throughout
+//so a pool inside a memcpy'd state block stays trivially copyable. Slots holds a
+//permutation of the slot numbers: the first Count are in use, in no particular order,
+//and the rest are free. Position is each slot's place in it, so acquire, release and
+//walking the live items all cost O(live), never O(Capacity)
+template<typename T, unsigned int Capacity>
+struct FixedPool {
+	T Items[Capacity];
+	unsigned int Slots[Capacity];
+	unsigned int Position[Capacity];
+	unsigned int Generation[Capacity];
+	unsigned int Count;
+
+	//O(Capacity), only when the pool is set up or thrown away as a whole
+	void clear() {
+		for (unsigned int i{ 0 }; i < Capacity; ++i) {
+			Slots[i] = i;
+			Position[i] = i;
+			Generation[i] = 0;
+		}
+		Count = 0;
+	}
+	bool full() const { return Count == Capacity; }
+
+	//the i-th live item, i < Count
+	T& live(unsigned int i) { return Items[Slots[i]]; }
+	const T& live(unsigned int i) const { return Items[Slots[i]]; }
+	PoolHandle handle(unsigned int i) const { return PoolHandle{ Slots[i], Generation[Slots[i]] }; }
+
+	//the item is left as it was, set it up through the returned pointer; nullptr when full
+	T* acquire(PoolHandle* handle = nullptr) {
+		if (full()) {
+			return nullptr;
+		}
+		unsigned int slot = Slots[Count++];
+		if (handle) {
+			*handle = PoolHandle{ slot, Generation[slot] };
+		}
+		return &Items[slot];
+	}
+	T* get(PoolHandle handle) {
+		bool valid = handle.Index < Capacity && Generation[handle.Index] == handle.Generation && Position[handle.Index] < Count;
+		return valid ? &Items[handle.Index] : nullptr;
+	}
+	//releasing the i-th live item moves the last live one into place i, so walk backwards
+	//(or don't advance) when releasing while iterating
+	void releaseLive(unsigned int i) {
+		unsigned int slot = Slots[i];
+		unsigned int last = Slots[--Count];
+		Slots[i] = last;
+		Position[last] = i;
+		Slots[Count] = slot;
+		Position[slot] = Count;
+		Generation[slot]++;
+	}
+	void release(PoolHandle handle) {
+		if (get(handle)) {
+			releaseLive(Position[handle.Index]);
+		}
+	}
+};
+
+#endif
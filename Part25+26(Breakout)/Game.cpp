@@ -1,275 +1,373 @@
-#include "Game.h"
-
-SpriteRenderer* renderer;
-
-const glm::vec2 PLAYER_SIZE{ 100.f, 20.f };
-const float PLAYER_VELOCITY{ 400.f };
-
-const glm::vec2 INIT_BALL_VELOCITY{ 100.f,-350.f };
-const float BALL_RADIUS{ 12.5f };
-
-GameObject* Player;
-BallObject* Ball;
-TextRenderer* Text;
-
-using namespace irrklang;
-
-ISoundEngine* SoundEngine = createIrrKlangDevice();
-
-Game::Game(unsigned int Width, unsigned int Height)
-	: state(GAME_MENU), keys(), width(Width), height(Height)
-{
-	
-}
-
-Game::~Game() {
-	delete renderer;
-}
-void Game::Init() {
-	ResourceManager::LoadShader("shaders/sprite.vs", "shaders/sprite.fs", NULL, "sprite");
-	SoundEngine->play2D("sound/silence.mp3", false);
-	lives = 3;
-	speedMod = 1.0f;
-
-	Text = new TextRenderer(width, height);
-	Text->Load("fonts/Prata-Regular.ttf", 48);
-
-	glm::mat4 projection = glm::ortho(0.f, static_cast<float>(this->width), static_cast<float>(this->height), 0.f, -1.f, 1.f);
-	ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
-	ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
-
-	renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
-	
-	ResourceManager::LoadTexture("textures/block.png", false, "block");
-	ResourceManager::LoadTexture("textures/block_solid.png", false, "block_solid");
-	ResourceManager::LoadTexture("textures/background.jpg", false, "background");
-	ResourceManager::LoadTexture("textures/awesomeface.png", true, "face");
-	GameLevel one; one.load("level/one.txt", width, height / 2);
-	GameLevel two; two.load("level/two.txt", width, height / 2);
-	GameLevel three; three.load("level/three.txt", width, height / 2);
-	GameLevel four; four.load("level/four.txt", width, height / 2);
-	Levels.push_back(one);
-	Levels.push_back(two);
-	Levels.push_back(three);
-	Levels.push_back(four);
-	level = 2;
-
-	ResourceManager::LoadTexture("textures/paddle.png", true, "paddle");
-	glm::vec2 playerPos{ width / 2.f - PLAYER_SIZE.x / 2.f, height - PLAYER_SIZE.y };
-	Player = new GameObject{ playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle") };
-
-	glm::vec2 ballPos{playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, BALL_RADIUS * -2.f)};
-
-	Ball = new BallObject{ballPos, BALL_RADIUS, INIT_BALL_VELOCITY, ResourceManager::GetTexture("face")};
-}
-
-void Game::resetPlayer() {
-	Player->Position = glm::vec2(width / 2.f - PLAYER_SIZE.x / 2.f, height - PLAYER_SIZE.y);
-
-	Ball->Position = Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, BALL_RADIUS * -2.f);
-	Ball->Stuck = true;
-	speedMod = 1.025f;
-}
-
-void Game::resetLevel() {
-	for (auto &x : Levels[level].Bricks) {
-		x.Destroyed = false;
-	}
-	lives = 3;
-	speedMod = 1.0f;
-}
-
-Collision Game::checkCollision(GameObject &one, GameObject &two) //AABB - AABB collison
-{
-	bool collisionX = one.Position.x + one.Size.x >= two.Position.x && two.Position.x + two.Size.x >= one.Position.x;
-	bool collisionY = one.Position.y + one.Size.y >= two.Position.y && two.Position.y + two.Size.y >= one.Position.y;
-
-	return std::make_tuple(collisionX && collisionY, UP, glm::vec2(0.0));
-}
-
-Collision Game::checkCollision(BallObject& one, GameObject& two) {
-	glm::vec2 center(one.Position + one.Radius);
-
-	glm::vec2 aabb_half(two.Size.x/2.0, two.Size.y/2.0);
-	glm::vec2 aabb_center(two.Position.x + aabb_half.x, two.Position.y + aabb_half.y);
-
-	glm::vec2 difference = center - aabb_center;
-
-	glm::vec2 clamped = glm::clamp(difference, -aabb_half, aabb_half);
-	glm::vec2 closest = aabb_center + clamped;
-
-	difference = closest - center;
-	if (glm::length(difference) < one.Radius) {
-		return std::make_tuple(true, VectorDirection(difference), difference);
-	}
-	else {
-		return std::make_tuple(false, UP, glm::vec2(0.0));
-	}
-}
-
-Direction Game::VectorDirection(glm::vec2 target) {
-	glm::vec2 compass[]{
-		glm::vec2(0.0, 1.0),
-		glm::vec2(1.0, 0.0),
-		glm::vec2(0.0, -1.0),
-		glm::vec2(-1.0, 0.0),
-	};
-	float max = 0.f;
-	int bestMatch = 0;
-	for (int i{ 0 }; i < 4; i++) {
-		float dot_product = glm::dot(glm::normalize(target), compass[i]);
-		if (dot_product > max) {
-			dot_product = max;
-			bestMatch = i;
-		}
-	}
-	return (Direction)bestMatch;
-}
-
-void Game::processInput(float dt) {
-	if (state == GAME_ACTIVE) {
-		float velocity = PLAYER_VELOCITY * dt;
-		
-		if (keys[GLFW_KEY_A])
-		{
-			if (Player->Position.x >= 0.0f) {
-				Player->Position.x -= velocity;
-				if (Ball->Stuck) {
-					Ball->Position.x -= velocity;
-				}
-			}
-		}
-		if (keys[GLFW_KEY_D])
-		{
-			if (Player->Position.x <= width - Player->Size.x){
-				Player->Position.x += velocity;
-				if (Ball->Stuck) {
-					Ball->Position.x += velocity;
-				}
-			}
-		}
-		if (keys[GLFW_KEY_SPACE]) {
-			Ball->Stuck = false;
-		}
-	}
-	else if (state == GAME_MENU) {
-		if (keys[GLFW_KEY_ENTER]) {
-			state = GAME_ACTIVE;
-		}
-		if (keys[GLFW_KEY_1]) {
-			level = 0;
-		}
-		if (keys[GLFW_KEY_2]) {
-			level = 1;
-		}
-		if (keys[GLFW_KEY_3]) {
-			level = 2;
-		}
-		if (keys[GLFW_KEY_4]) {
-			level = 3;
-		}
-	}
-	else if (state == GAME_WIN) {
-		if (keys[GLFW_KEY_ENTER]) {
-			state = GAME_MENU;
-		}
-	}
-}
-void Game::update(float dt) {
-	if (state == GAME_ACTIVE) {
-		Ball->Move(dt, width, speedMod);
-
-		doCollision();
-
-		if (Ball->Position.y >= height) {
-			SoundEngine->play2D("sound/lose.wav", false);
-			lives--;
-
-			if (lives <= 0) {
-				resetLevel();
-				state = GAME_MENU;
-			}
-			resetPlayer();
-		}
-
-		if (Levels[level].isCompleted()) {
-			resetLevel();
-			resetPlayer();
-			state = GAME_WIN;
-		}
-	}
-}
-
-void Game::render() {
-	renderer->drawSprite(ResourceManager::GetTexture("background"), glm::vec2(0.0, 0.0), glm::vec2(width, height), 0.f);
-	if (this->state == GAME_ACTIVE || this->state == GAME_MENU) {
-
-		Levels[level].draw(*renderer);
-
-		Player->Draw(*renderer);
-
-		Ball->Draw(*renderer);
-
-		if (state == GAME_ACTIVE) {
-			Text->RenderText("Lives: " + std::to_string(lives), 5.f, 5.f, 0.5f);
-		}
-		else {
-			Text->RenderText("Press ENTER to Start", 250.f, height/2.f, 0.5f);
-			Text->RenderText("Type '1', '2', '3', or '4' to select a level", 245.f, height / 2.f + 40.f, 0.5f);
-		}
-	}
-	else if (state == GAME_WIN) {
-		Text->RenderText("YOU WON!", 250.f, height / 2.f, 0.5f);
-		Text->RenderText("Type ENTER to play again or ESC to quit", 245.f, height / 2.f + 40.f, 0.5f);
-	}
-}
-
-void Game::doCollision() {
-	for (GameObject& box : Levels[level].Bricks) {
-		if (!box.Destroyed) {
-			Collision coll = checkCollision(*Ball, box);
-			if (std::get<0>(coll)){
-				if (!box.IsSolid) {
-					box.Destroyed = true;
-					SoundEngine->play2D("sound/bleep.mp3", false);
-					speedMod += 0.025;
-				}
-				else {
-					SoundEngine->play2D("sound/solid.wav", false);
-				}
-
-				Direction dir = std::get<1>(coll);
-				glm::vec2 dirVec = std::get<2>(coll);
-				if (dir == LEFT || dir == RIGHT) {
-					Ball->Velocity.x = -Ball->Velocity.x;
-
-					float penetration = Ball->Radius - std::abs(dirVec.x);
-					Ball->Position.x += dir == LEFT ? penetration : -penetration;
-				}
-				else {
-					Ball->Velocity.y = -Ball->Velocity.y;
-
-					float penetration = Ball->Radius - std::abs(dirVec.y);
-					Ball->Position.y += dir == DOWN ? penetration : -penetration;
-				}
-			}
-		}
-	}
-
-	if (!Ball->Stuck) {
-		Collision result = checkCollision(*Ball, *Player);
-		if (std::get<0>(result)) {
-			SoundEngine->play2D("sound/bleepPaddle.wav", false);
-			float centerBoard = Player->Position.x + Player->Size.x/2.0f;
-			float distance = (Ball->Position.x + Ball->Size.x) - centerBoard;
-			float percent = distance / (Player->Size.x/2.0f);
-
-			float strength = 2.f;
-			glm::vec2 oldVelocity = Ball->Velocity;
-			Ball->Velocity.x = INIT_BALL_VELOCITY.x * percent * strength;
-			Ball->Velocity.y = -1.0f * std::abs(Ball->Velocity.y);
-			Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(oldVelocity);
-		}
-
-	}
-}
\ No newline at end of file
+#include "Game.h"
+#include "ThreadPool.h"
+
+#include <cmath>
+#include <algorithm>
+#include <random>
+
+SpriteRenderer* renderer;
+TextRenderer* Text;
+ParticleSystem* Particles;
+ParticleRenderer* particleRenderer;
+PostProcessor* Effects;
+LevelLayer* Layer;
+
+//positions at the start of the current tick, used to interpolate when rendering
+glm::vec2 prevPlayerPos;
+BallSet prevBalls;
+
+AudioSystem* Audio;
+
+const std::vector<AtlasSource> SPRITE_ATLAS_SOURCES{
+	{ "block", "textures/block.png" },
+	{ "block_solid", "textures/block_solid.png" },
+	{ "face", "textures/awesomeface.png" },
+	{ "paddle", "textures/paddle.png" },
+};
+const unsigned int SPRITE_ATLAS_PADDING{ 4 };
+
+//a ball leaves ~120 trail particles at a time and a brick 48 debris, so this covers
+//hundreds of balls before new particles get dropped
+const unsigned int MAX_PARTICLES{ 1 << 17 };
+
+Game::Game(unsigned int Width, unsigned int Height)
+	: keys(), width(Width), height(Height), sim(Width, Height),
+	shakeTime(0.f), confuseTime(0.f), chaosTime(0.f), elapsed(0.f), layerLevel(nullptr)
+{
+	
+}
+
+Game::~Game() {
+	delete renderer;
+	delete Text;
+	delete particleRenderer;
+	delete Particles;
+	delete Effects;
+	delete Layer;
+	delete Audio;
+}
+void Game::Init(const std::vector<TextureRequest>& extraTextures, bool serialTextures) {
+	//every sound is decoded here, once; after that the game only queues handles
+	Audio = new AudioSystem(new IrrKlangAudioBackend());
+	brickSound = Audio->loadSound("sound/bleep.mp3");
+	solidSound = Audio->loadSound("sound/solid.wav");
+	paddleSound = Audio->loadSound("sound/bleepPaddle.wav");
+	loseSound = Audio->loadSound("sound/lose.wav");
+	powerUpSound = Audio->loadSound("sound/powerup.wav");
+	Audio->play(Audio->loadSound("sound/silence.mp3"));
+	Audio->start();
+	ShaderHandle sprite = ResourceManager::LoadShader("shaders/sprite.vs", "shaders/sprite.fs", NULL, "sprite");
+	ShaderHandle spriteBatch = ResourceManager::LoadShader("shaders/sprite_batch.vs", "shaders/sprite_batch.fs", NULL, "sprite_batch");
+	ShaderHandle particle = ResourceManager::LoadShader("shaders/particle.vs", "shaders/particle.fs", NULL, "particle");
+	ShaderHandle post = ResourceManager::LoadShader("shaders/post.vs", "shaders/post.fs", NULL, "post");
+
+	Text = new TextRenderer(width, height);
+	Text->Load("fonts/Prata-Regular.ttf", 48);
+	startText = Text->CreateText();
+	selectText = Text->CreateText();
+	wonText = Text->CreateText();
+	againText = Text->CreateText();
+	livesText = Text->CreateText();
+	Text->SetText(startText, "Press ENTER to Start", 250.f, height / 2.f, 0.5f);
+	Text->SetText(selectText, "Type '1', '2', '3', or '4' to select a level", 245.f, height / 2.f + 40.f, 0.5f);
+	Text->SetText(wonText, "YOU WON!", 250.f, height / 2.f, 0.5f);
+	Text->SetText(againText, "Type ENTER to play again or ESC to quit", 245.f, height / 2.f + 40.f, 0.5f);
+	livesShown = false;
+
+	glm::mat4 projection = glm::ortho(0.f, static_cast<float>(this->width), static_cast<float>(this->height), 0.f, -1.f, 1.f);
+	ResourceManager::GetShader(sprite).Use().SetInteger("image", 0);
+	ResourceManager::GetShader(sprite).SetMatrix4("projection", projection);
+	ResourceManager::GetShader(spriteBatch).Use().SetInteger("image", 0);
+	ResourceManager::GetShader(spriteBatch).SetMatrix4("projection", projection);
+	ResourceManager::GetShader(particle).Use().SetMatrix4("projection", projection);
+
+	renderer = new SpriteRenderer(ResourceManager::GetShader(sprite), ResourceManager::GetShader(spriteBatch));
+
+	Particles = new ParticleSystem(MAX_PARTICLES);
+	Particles->Gravity = 300.f;
+	Particles->Drag = 1.5f;
+	particleRenderer = new ParticleRenderer(ResourceManager::GetShader(particle), MAX_PARTICLES);
+	//sized to the window here, resize() follows the real framebuffer size after that
+	Effects = new PostProcessor(ResourceManager::GetShader(post), width, height);
+	Layer = new LevelLayer(width, height, glm::vec2(width, height));
+	//trail: slow sparks drifting off the ball in every direction
+	trailEmitter = ParticleEmitter{ glm::vec2(0.f, -1.f), 3.14159265f, 20.f, 15.f, 0.5f, 0.15f, 6.f, glm::vec4(1.f, 0.6f, 0.2f, 0.6f), 240.f, 0.f };
+	//debris: bursts upwards out of the brick and falls back down
+	debrisEmitter = ParticleEmitter{ glm::vec2(0.f, -1.f), 1.2f, 140.f, 80.f, 0.8f, 0.3f, 5.f, glm::vec4(1.f), 0.f, 0.f };
+	
+	//a single loose image isn't worth starting decode threads for, so the pool only exists
+	//when there's more to load with it
+	std::vector<TextureRequest> textures{ TextureRequest{ "textures/background.jpg", false, "background" } };
+	textures.insert(textures.end(), extraTextures.begin(), extraTextures.end());
+	if (extraTextures.empty() || serialTextures) {
+		backgroundTexture = ResourceManager::LoadTextures(textures, nullptr)[0];
+	}
+	else {
+		ThreadPool pool;
+		backgroundTexture = ResourceManager::LoadTextures(textures, &pool)[0];
+	}
+	//the small sprites all live in one atlas so they share a single batch; it's normally
+	//built offline (BreakoutHeadless --build-atlas) but we can make it on first run too
+	if (!ResourceManager::LoadAtlas("textures/sprites.atlas", "sprites")) {
+		ResourceManager::BuildAtlas(SPRITE_ATLAS_SOURCES, SPRITE_ATLAS_PADDING, "textures/sprites.atlas");
+		ResourceManager::LoadAtlas("textures/sprites.atlas", "sprites");
+	}
+	blockSprite = ResourceManager::FindSprite("block");
+	solidSprite = ResourceManager::FindSprite("block_solid");
+	paddleSprite = ResourceManager::FindSprite("paddle");
+	faceSprite = ResourceManager::FindSprite("face");
+
+	//only the paths are recorded here, levels load in the background once highlighted
+	sim.addLevel("level/one.txt");
+	sim.addLevel("level/two.txt");
+	sim.addLevel("level/three.txt");
+	sim.addLevel("level/four.txt");
+	sim.State.level = 2;
+	//different drops every run; a recording keeps the seed so replays get the same ones
+	sim.Init(std::random_device{}());
+
+	prevPlayerPos = sim.State.Player.Position;
+	prevBalls = sim.State.Balls;
+}
+
+void Game::tick(float dt) {
+	prevPlayerPos = sim.State.Player.Position;
+	prevBalls = sim.State.Balls;
+
+	unsigned int input = processInput();
+	if (Recorder.active()) {
+		Recorder.record(input);
+	}
+	sim.tick(input, dt);
+
+	playEvents();
+
+	//particles are only for show, so they don't need the simulation's care: they move on
+	//the same ticks but nothing reads them back
+	const BallSet& balls = sim.State.Balls;
+	unsigned int trail = trailEmitter.due(dt);
+	for (unsigned int i{ 0 }; i < balls.Count; ++i) {
+		if (!balls.Stuck[i]) {
+			glm::vec2 spread{ balls.Radius * 0.5f };
+			Particles->emit(trailEmitter, balls.center(i) - spread, balls.center(i) + spread, trail);
+		}
+	}
+	Particles->update(dt);
+
+	updateEffects(dt);
+}
+
+void Game::resize(unsigned int framebufferWidth, unsigned int framebufferHeight) {
+	if (Effects && framebufferWidth > 0 && framebufferHeight > 0) {
+		Effects->resize(framebufferWidth, framebufferHeight);
+		Layer->resize(framebufferWidth, framebufferHeight);
+	}
+}
+
+void Game::updateEffects(float dt) {
+	elapsed += dt;
+	shakeTime = std::max(0.f, shakeTime - dt);
+	confuseTime = std::max(0.f, confuseTime - dt);
+	chaosTime = std::max(0.f, chaosTime - dt);
+
+	Effects->Shake = shakeTime > 0.f ? 4.f : 0.f;
+	Effects->Confuse = confuseTime > 0.f;
+	Effects->Chaos = chaosTime > 0.f;
+	//the corners close in and pulse while the player is on their last life
+	bool lastLife = sim.State.state == GAME_ACTIVE && sim.State.lives == 1;
+	Effects->Vignette = lastLife ? 0.6f + 0.2f * std::sin(elapsed * 4.f) : 0.3f;
+}
+
+unsigned int Game::processInput() {
+	unsigned int input = 0;
+	if (keys[GLFW_KEY_A]) input |= INPUT_LEFT;
+	if (keys[GLFW_KEY_D]) input |= INPUT_RIGHT;
+	if (keys[GLFW_KEY_SPACE]) input |= INPUT_LAUNCH;
+	if (keys[GLFW_KEY_ENTER]) input |= INPUT_CONFIRM;
+	for (unsigned int i{ 0 }; i < 4; i++) {
+		if (keys[GLFW_KEY_1 + i]) input |= INPUT_LEVEL_1 << i;
+	}
+	return input;
+}
+
+void Game::playEvents() {
+	for (const SimEvent& e : sim.Events) {
+		switch (e.type) {
+		case EVENT_BRICK_DESTROYED: {
+			Audio->play(brickSound);
+			emitDebris(e.brick);
+			const BrickStore& bricks = sim.Levels[sim.State.level].Bricks;
+			Layer->invalidate(bricks.Min[e.brick], bricks.Max[e.brick]);
+			break;
+		}
+		case EVENT_LEVEL_RESET: Layer->invalidate(); break;
+		case EVENT_SOLID_HIT:
+			Audio->play(solidSound);
+			shakeTime = 0.05f;
+			break;
+		case EVENT_PADDLE_HIT: Audio->play(paddleSound); break;
+		case EVENT_POWERUP_ACTIVATED: Audio->play(powerUpSound); break;
+		case EVENT_BALL_LOST:
+			Audio->play(loseSound);
+			shakeTime = 0.2f;
+			chaosTime = 0.4f;
+			//that was the last life, the game has gone back to the menu
+			if (sim.State.state == GAME_MENU) {
+				confuseTime = 0.8f;
+			}
+			break;
+		case EVENT_PLAYER_RESET:
+			//teleport, don't interpolate from where the ball was lost
+			prevPlayerPos = sim.State.Player.Position;
+			prevBalls = sim.State.Balls;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void Game::render(float alpha) {
+	//the highlighted level may still be loading; the menu just shows no bricks until it's in
+	bool playing = sim.State.state == GAME_ACTIVE || sim.State.state == GAME_MENU;
+	refreshLayer(playing ? sim.Levels.ready(sim.State.level) : nullptr);
+
+	//the scene goes into the offscreen target, then one pass resolves it and applies the
+	//effects; text goes on top afterwards so the HUD stays readable
+	Effects->begin();
+
+	//one instanced draw for the background and bricks, already in the layer, and one for
+	//everything in the sprite atlas
+	renderer->begin();
+	renderer->submit(Layer->sprite(), glm::vec2(0.f), glm::vec2(width, height), 0.f);
+	if (playing) {
+		GameObject& player = sim.State.Player;
+		glm::vec2 playerPos = glm::mix(prevPlayerPos, player.Position, alpha);
+		renderer->submit(ResourceManager::GetSprite(paddleSprite), playerPos, player.Size, player.Rotation, player.Color);
+
+		//falling power-ups are brick sprites in their type's color
+		const PowerUpPool& powerUps = sim.State.PowerUps;
+		for (unsigned int i{ 0 }; i < powerUps.Count; ++i) {
+			const GameObject& object = powerUps.live(i).Object;
+			renderer->submit(ResourceManager::GetSprite(blockSprite), object.Position, object.Size, 0.f, object.Color);
+		}
+
+		//balls are swapped around when one is lost, so only interpolate while the set is unchanged
+		const BallSet& balls = sim.State.Balls;
+		bool interpolate = prevBalls.Count == balls.Count;
+		glm::vec2 ballSize{ balls.Radius * 2.f };
+		for (unsigned int i{ 0 }; i < balls.Count; ++i) {
+			glm::vec2 ballPos = balls.center(i);
+			if (interpolate) {
+				ballPos = glm::mix(prevBalls.center(i), ballPos, alpha);
+			}
+			renderer->submit(ResourceManager::GetSprite(faceSprite), ballPos - balls.Radius, ballSize, 0.f);
+		}
+	}
+	renderer->flush();
+	particleRenderer->draw(*Particles);
+
+	Effects->end();
+	Effects->composite(elapsed);
+
+	//every string on screen is a cached mesh, so text is just a draw call each
+	if (sim.State.state == GAME_ACTIVE) {
+		if (!livesShown || sim.State.lives != shownLives) {
+			shownLives = sim.State.lives;
+			livesShown = true;
+			Text->SetText(livesText, "Lives: " + std::to_string(shownLives), 5.f, 5.f, 0.5f);
+		}
+		Text->DrawText(livesText);
+	}
+	else if (sim.State.state == GAME_MENU) {
+		Text->DrawText(startText);
+		Text->DrawText(selectText);
+	}
+	else if (sim.State.state == GAME_WIN) {
+		Text->DrawText(wonText);
+		Text->DrawText(againText);
+	}
+}
+
+double Game::timeLevelDraw(GameLevel& level, unsigned int frames, bool cached) {
+	BrickStore& bricks = level.Bricks;
+	unsigned int next = 0;
+	if (cached) {
+		//level may sit where the last one did, so don't let the address vouch for it
+		Layer->invalidate();
+		refreshLayer(&level);
+	}
+	glFinish();
+	double start = glfwGetTime();
+	for (unsigned int f{ 0 }; f < frames; ++f) {
+		if (cached) {
+			while (next < bricks.size() && (bricks.isSolid(next) || bricks.isDestroyed(next))) {
+				next++;
+			}
+			if (next < bricks.size()) {
+				bricks.destroy(next);
+				Layer->invalidate(bricks.Min[next], bricks.Max[next]);
+			}
+			refreshLayer(&level);
+			renderer->begin();
+			renderer->submit(Layer->sprite(), glm::vec2(0.f), glm::vec2(width, height), 0.f);
+		}
+		else {
+			renderer->begin();
+			renderLevel(level);
+		}
+		renderer->flush();
+		glFinish();
+	}
+	double ms = (glfwGetTime() - start) * 1e3 / frames;
+	if (cached) {
+		bricks.resetDestroyed();
+		Layer->invalidate();
+		layerLevel = nullptr;
+	}
+	return ms;
+}
+
+void Game::refreshLayer(GameLevel* level) {
+	if (level != layerLevel) {
+		layerLevel = level;
+		Layer->invalidate();
+	}
+	if (!Layer->dirty()) {
+		return;
+	}
+	TextureRef background = ResourceManager::GetTexture(backgroundTexture);
+	AtlasSprite& block = ResourceManager::GetSprite(blockSprite);
+	AtlasSprite& solid = ResourceManager::GetSprite(solidSprite);
+	Layer->refresh([&](glm::vec2 min, glm::vec2 max) {
+		//the scissor keeps the full-screen background to the area
+		renderer->begin();
+		renderer->submit(background, glm::vec2(0.f), glm::vec2(width, height), 0.f);
+		if (level) {
+			BrickStore& bricks = level->Bricks;
+			level->queryArea(min, max, [&](unsigned int i) {
+				if (!bricks.isDestroyed(i)) {
+					renderer->submit(bricks.isSolid(i) ? solid : block, bricks.Min[i], bricks.Max[i] - bricks.Min[i], 0.f, bricks.Color[i]);
+				}
+			});
+		}
+		renderer->flush();
+	});
+}
+
+void Game::renderLevel(GameLevel& level) {
+	AtlasSprite& block = ResourceManager::GetSprite(blockSprite);
+	AtlasSprite& solid = ResourceManager::GetSprite(solidSprite);
+	BrickStore& bricks = level.Bricks;
+	for (unsigned int i{ 0 }; i < bricks.size(); ++i) {
+		if (!bricks.isDestroyed(i)) {
+			renderer->submit(bricks.isSolid(i) ? solid : block, bricks.Min[i], bricks.Max[i] - bricks.Min[i], 0.f, bricks.Color[i]);
+		}
+	}
+}
+
+void Game::emitDebris(unsigned int brick) {
+	const BrickStore& bricks = sim.Levels[sim.State.level].Bricks;
+	debrisEmitter.Color = glm::vec4(bricks.Color[brick], 1.f);
+	Particles->emit(debrisEmitter, bricks.Min[brick], bricks.Max[brick], 48);
+}
@@ -1,57 +1,72 @@
-#ifndef GAME_H
-#define GAME_H
-#include "SpriteRenderer.h"
-#include "TextRenderer.h"
-#include "GameLevel.h"
-#include "ResourceManager.h"
-#include "Ball.h"
-#include <irrKlang/irrKlang.h>
-
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
-#include <tuple>
-
-enum GameState {
-	GAME_ACTIVE,
-	GAME_MENU,
-	GAME_WIN
-};
-
-enum Direction {
-	UP,
-	RIGHT,
-	DOWN,
-	LEFT,
-};
-typedef std::tuple<bool, Direction, glm::vec2> Collision;
-
-class Game {
-public:
-	GameState state;
-	bool keys[1024];
-	unsigned int width, height;
-
-	std::vector<GameLevel> Levels;
-	unsigned int level;
-	unsigned int lives;
-	float speedMod;
-
-	Game(unsigned int Width, unsigned int Height);
-	~Game();
-
-	void Init();
-
-	void doCollision();
-	Collision checkCollision(GameObject& one, GameObject& two);
-	Collision checkCollision(BallObject& one, GameObject& two);
-	Direction VectorDirection(glm::vec2 target);
-
-	void resetPlayer();
-	void resetLevel();
-
-	void processInput(float dt);
-	void update(float dt);
-	void render();
-};
-
-#endif
\ No newline at end of file
+#ifndef GAME_H
+#define GAME_H
+#include "SpriteRenderer.h"
+#include "TextRenderer.h"
+#include "ParticleRenderer.h"
+#include "PostProcessor.h"
+#include "LevelLayer.h"
+#include "GameSimulation.h"
+#include "ResourceManager.h"
+#include "IrrKlangAudio.h"
+#include "InputRecording.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+//presentation layer: turns key state into simulation input, draws the
+//simulation and plays sounds for the events it reports
+class Game {
+public:
+	bool keys[1024];
+	unsigned int width, height;
+
+	GameSimulation sim;
+	//records every tick's input once begun, see InputRecording.h
+	InputRecorder Recorder;
+
+	Game(unsigned int Width, unsigned int Height);
+	~Game();
+
+	//extraTextures are loaded alongside the background in one batch, decoded on a thread
+	//pool unless serialTextures is set; for timing startup with a texture-heavy set
+	void Init(const std::vector<TextureRequest>& extraTextures = {}, bool serialTextures = false);
+
+	//advances the game by one fixed simulation step
+	void tick(float dt);
+	//maps the currently held keys to simulation input flags
+	unsigned int processInput();
+	//alpha is how far (0-1) we are between the last tick and the next one
+	void render(float alpha = 1.f);
+	//average milliseconds per frame to draw level's bricks, waiting for the GPU each frame;
+	//for Breakout --bench scaling. Uncached every brick goes through the batched path each
+	//frame; cached, each frame destroys a brick and redraws just its area of the layer
+	double timeLevelDraw(GameLevel& level, unsigned int frames, bool cached = false);
+	//the window's framebuffer changed size, in pixels
+	void resize(unsigned int framebufferWidth, unsigned int framebufferHeight);
+private:
+	//resolved once in Init so rendering never looks anything up by name
+	TextureHandle backgroundTexture;
+	SpriteHandle blockSprite, solidSprite, paddleSprite, faceSprite;
+	//text is laid out once; the HUD only gets rebuilt when the lives count changes
+	TextMeshHandle startText, selectText, wonText, againText, livesText;
+	SoundHandle brickSound, solidSound, paddleSound, loseSound, powerUpSound;
+	//a trail behind every ball in flight and a burst of debris for every brick destroyed
+	ParticleEmitter trailEmitter, debrisEmitter;
+	//seconds each screen effect has left to run, started by simulation events
+	float shakeTime, confuseTime, chaosTime;
+	float elapsed;
+	//lives count the HUD text was last built for; livesShown is false until it's built
+	unsigned int shownLives;
+	bool livesShown;
+	//what the level layer currently shows, nullptr for just the background
+	const GameLevel* layerLevel;
+
+	void renderLevel(GameLevel& level);
+	//brings the level layer up to date with level, drawing only what changed
+	void refreshLayer(GameLevel* level);
+	void playEvents();
+	void emitDebris(unsigned int brick);
+	void updateEffects(float dt);
+};
+
+#endif
@@ -1,72 +1,132 @@
-#include "GameLevel.h"
-
-void GameLevel::load(const char* file, unsigned int levelWidth, unsigned int levelHeight) {
-	this->Bricks.clear();
-
-	unsigned int tileCode;
-	GameLevel level;
-	std::string line;
-    std::ifstream fstream(file);
-	std::vector<std::vector<unsigned int>> tileData;
-	if (fstream) {
-		while (std::getline(fstream, line))
-		{
-			std::istringstream sstream(line);
-			std::vector<unsigned int> row;
-			while (sstream >> tileCode) {
-				row.push_back(tileCode);
-			}
-			tileData.push_back(row);
-		}
-		if (tileData.size() > 0) {
-			this->init(tileData, levelWidth, levelHeight);
-		}
-	}
-}
-
-void GameLevel::draw(SpriteRenderer& renderer) {
-	for (auto &x : Bricks) {
-		if (!x.Destroyed) {
-			x.Draw(renderer);
-		}
-	}
-}
-
-bool GameLevel::isCompleted() {
-	for (auto &x : Bricks) {
-		if (!x.IsSolid && !x.Destroyed) {
-			return false;
-		}
-	}
-	return true;
-}
-
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight) {
-	unsigned int height = tileData.size();
-	unsigned int width = tileData[0].size();
-	float unitWidth = levelWidth / static_cast<float>(width);
-	float unitHeight = levelHeight / static_cast<float>(height);
-	for (int y{ 0 }; y < height; ++y) {
-		for (int x{ 0 }; x < width; ++x) {
-			if (tileData[y][x] == 1) {
-				glm::vec2 pos{unitWidth * x, unitHeight * y};
-				glm::vec2 size{ unitWidth, unitHeight };
-				GameObject obj{ pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f) };
-				obj.IsSolid = true;
-				Bricks.push_back(obj);
-			}
-			else if (tileData[y][x] > 1) {
-				glm::vec3 color{ 1.f };
-				switch (tileData[y][x]) {
-				case(2): color = glm::vec3(0.2f, 0.6f, 1.0f); break;
-				case(3): color = glm::vec3(0.0f, 0.7f, 0.0f); break;
-				case(4): color = glm::vec3(0.8f, 0.8f, 0.4f); break;
-				case(5): color = glm::vec3(1.0f, 0.5f, 0.0f); break;
-				}
-				glm::vec2 pos{ unitWidth * x, unitHeight * y };
-				glm::vec2 size{ unitWidth, unitHeight };
-				Bricks.push_back(GameObject{ pos, size, ResourceManager::GetTexture("block"), color });
-			}
-		}
-	}
+#include "GameLevel.h"
+#include "LevelFile.h"
+#include <algorithm>
+
+void GameLevel::load(const char* file, unsigned int levelWidth, unsigned int levelHeight) {
+	this->Bricks.clear();
+	this->Grid.clear();
+
+	MappedFile mapped;
+	unsigned int columns, rows;
+	if (!mapped.open(file)) {
+		return;
+	}
+	if (readLevelHeader(mapped.data(), mapped.size(), columns, rows)) {
+		//compiled levels are built straight out of the mapping
+		this->init(mapped.data() + LEVEL_HEADER_SIZE, columns, rows, levelWidth, levelHeight);
+	}
+	else {
+		std::vector<unsigned char> tiles;
+		if (parseLevelText(reinterpret_cast<const char*>(mapped.data()), mapped.size(), tiles, columns, rows)) {
+			this->init(tiles.data(), columns, rows, levelWidth, levelHeight);
+		}
+	}
+}
+
+void BrickStore::clear() {
+	Min.clear();
+	Max.clear();
+	Color.clear();
+	Destroyed.clear();
+	SolidBits.clear();
+}
+
+unsigned int BrickStore::add(glm::vec2 min, glm::vec2 max, glm::vec3 color, bool solid) {
+	unsigned int i = size();
+	if ((i & 63) == 0) {
+		SolidBits.push_back(0);
+	}
+	if (i % BitPages::PAGE_BITS == 0) {
+		Destroyed.grow(i + 1);
+	}
+	Min.push_back(min);
+	Max.push_back(max);
+	Color.push_back(color);
+	if (solid) {
+		SolidBits[i >> 6] |= 1ull << (i & 63);
+	}
+	return i;
+}
+
+void BrickStore::reserve(unsigned int count) {
+	Min.reserve(count);
+	Max.reserve(count);
+	Color.reserve(count);
+	Destroyed.reserve(count);
+	SolidBits.reserve((count + 63) / 64);
+}
+
+void BrickStore::resetDestroyed() {
+	Destroyed.reset();
+}
+
+void BitPages::grow(unsigned int bits) {
+	while (pages.size() * PAGE_BITS < bits) {
+		pages.push_back(std::make_shared<Page>());
+	}
+}
+
+void BitPages::reset() {
+	for (std::shared_ptr<Page>& page : pages) {
+		if (page.use_count() > 1) {
+			page = std::make_shared<Page>();
+		}
+		else {
+			page->fill(0ull);
+		}
+	}
+}
+
+bool GameLevel::isCompleted() {
+	//a set bit in ~(destroyed | solid) is a breakable brick still standing
+	unsigned int count = Bricks.size();
+	for (unsigned int w{ 0 }; w < Bricks.SolidBits.size(); ++w) {
+		unsigned long long alive = ~(Bricks.Destroyed.word(w) | Bricks.SolidBits[w]);
+		unsigned int used = std::min(64u, count - w * 64);
+		if (used < 64) {
+			alive &= (1ull << used) - 1;
+		}
+		if (alive) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void GameLevel::init(const unsigned char* tiles, unsigned int columns, unsigned int rows, unsigned int levelWidth, unsigned int levelHeight) {
+	unitWidth = levelWidth / static_cast<float>(columns);
+	unitHeight = levelHeight / static_cast<float>(rows);
+	gridWidth = columns;
+	gridHeight = rows;
+	Bricks.clear();
+	Grid.assign(columns * rows, -1);
+
+	//size everything once up front so building bricks never reallocates
+	unsigned int count = 0;
+	for (unsigned int i{ 0 }; i < columns * rows; ++i) {
+		count += tiles[i] != 0;
+	}
+	Bricks.reserve(count);
+
+	glm::vec2 size{ unitWidth, unitHeight };
+	for (unsigned int y{ 0 }; y < rows; ++y) {
+		const unsigned char* row = tiles + y * columns;
+		for (unsigned int x{ 0 }; x < columns; ++x) {
+			if (row[x] == 1) {
+				glm::vec2 pos{ unitWidth * x, unitHeight * y };
+				Grid[y * columns + x] = Bricks.add(pos, pos + size, glm::vec3(0.8f, 0.8f, 0.7f), true);
+			}
+			else if (row[x] > 1) {
+				glm::vec3 color{ 1.f };
+				switch (row[x]) {
+				case(2): color = glm::vec3(0.2f, 0.6f, 1.0f); break;
+				case(3): color = glm::vec3(0.0f, 0.7f, 0.0f); break;
+				case(4): color = glm::vec3(0.8f, 0.8f, 0.4f); break;
+				case(5): color = glm::vec3(1.0f, 0.5f, 0.0f); break;
+				}
+				glm::vec2 pos{ unitWidth * x, unitHeight * y };
+				Grid[y * columns + x] = Bricks.add(pos, pos + size, color, false);
+			}
+		}
+	}
 }
\ No newline at end of file
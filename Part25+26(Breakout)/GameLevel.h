@@ -1,24 +1,106 @@
-#ifndef GAMELEVEL_H
-#define GAMELEVEL_H
-#include <vector>
-#include <fstream>
-#include <sstream>
-#include "game_object.h"
-#include "ResourceManager.h"
-
-class GameLevel {
-public:
-	std::vector<GameObject> Bricks;
-
-	GameLevel() {}
-
-	void load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
-
-	void draw(SpriteRenderer &renderer);
-
-	bool isCompleted();
-private:
-	void init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
-};
-
-#endif // !GAMELEVEL_H
+#ifndef GAMELEVEL_H
+#define GAMELEVEL_H
+#include <vector>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+//a bitset split into fixed pages that copies share: copying one only copies the page
+//pointers, and a page is cloned the first time it's written while another copy still
+//holds it. Simulation snapshots use this so bricks that didn't change aren't copied
+class BitPages {
+public:
+	static const unsigned int PAGE_WORDS{ 64 };
+	static const unsigned int PAGE_BITS{ PAGE_WORDS * 64 };
+	typedef std::array<unsigned long long, PAGE_WORDS> Page;
+
+	bool test(unsigned int i) const { return ((*pages[i / PAGE_BITS])[(i / 64) % PAGE_WORDS] >> (i & 63)) & 1ull; }
+	void set(unsigned int i) { writable(i / PAGE_BITS)[(i / 64) % PAGE_WORDS] |= 1ull << (i & 63); }
+	void unset(unsigned int i) { writable(i / PAGE_BITS)[(i / 64) % PAGE_WORDS] &= ~(1ull << (i & 63)); }
+	unsigned long long word(unsigned int w) const { return (*pages[w / PAGE_WORDS])[w % PAGE_WORDS]; }
+
+	//makes room for at least bits bits, new ones cleared
+	void grow(unsigned int bits);
+	void reserve(unsigned int bits) { pages.reserve((bits + PAGE_BITS - 1) / PAGE_BITS); }
+	void clear() { pages.clear(); }
+	//clears every bit, dropping pages that are shared rather than writing to them
+	void reset();
+	unsigned int pageCount() const { return static_cast<unsigned int>(pages.size()); }
+private:
+	std::vector<std::shared_ptr<Page>> pages;
+
+	Page& writable(unsigned int page) {
+		if (pages[page].use_count() > 1) {
+			pages[page] = std::make_shared<Page>(*pages[page]);
+		}
+		return *pages[page];
+	}
+};
+
+//bricks stored as parallel arrays so each loop only pulls in the fields it
+//actually reads; destroyed/solid are bitsets, 64 bricks to a word
+class BrickStore {
+public:
+	std::vector<glm::vec2> Min, Max;
+	std::vector<glm::vec3> Color;
+	BitPages Destroyed;
+	std::vector<unsigned long long> SolidBits;
+
+	unsigned int size() const { return static_cast<unsigned int>(Min.size()); }
+	bool empty() const { return Min.empty(); }
+	void clear();
+	void reserve(unsigned int count);
+	//returns the index of the new brick
+	unsigned int add(glm::vec2 min, glm::vec2 max, glm::vec3 color, bool solid);
+
+	bool isDestroyed(unsigned int i) const { return Destroyed.test(i); }
+	bool isSolid(unsigned int i) const { return (SolidBits[i >> 6] >> (i & 63)) & 1ull; }
+	void destroy(unsigned int i) { Destroyed.set(i); }
+	void resetDestroyed();
+};
+
+class GameLevel {
+public:
+	BrickStore Bricks;
+
+	//bricks sit on a regular grid, so we keep that grid around as a spatial index:
+	//one entry per tile holding the index into Bricks, or -1 for an empty tile
+	std::vector<int> Grid;
+	unsigned int gridWidth, gridHeight;
+	float unitWidth, unitHeight;
+
+	GameLevel() : gridWidth(0), gridHeight(0), unitWidth(0.f), unitHeight(0.f) {}
+
+	//takes a compiled .lvl (see LevelFile.h) or the text format
+	void load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
+	//tiles is columns x rows tile codes, top row first
+	void init(const unsigned char* tiles, unsigned int columns, unsigned int rows, unsigned int levelWidth, unsigned int levelHeight);
+
+	//calls fn(brickIndex) for every brick in a tile overlapping [min, max], row by row
+	template<typename F>
+	void queryArea(glm::vec2 min, glm::vec2 max, F fn);
+
+	bool isCompleted();
+};
+
+template<typename F>
+void GameLevel::queryArea(glm::vec2 min, glm::vec2 max, F fn) {
+	if (Grid.empty() || max.x < 0.f || max.y < 0.f || min.x >= unitWidth * gridWidth || min.y >= unitHeight * gridHeight) {
+		return;
+	}
+	int x0 = std::max(0, static_cast<int>(min.x / unitWidth));
+	int y0 = std::max(0, static_cast<int>(min.y / unitHeight));
+	int x1 = std::min(static_cast<int>(gridWidth) - 1, static_cast<int>(max.x / unitWidth));
+	int y1 = std::min(static_cast<int>(gridHeight) - 1, static_cast<int>(max.y / unitHeight));
+	for (int y{ y0 }; y <= y1; ++y) {
+		const int* row = &Grid[y * gridWidth];
+		for (int x{ x0 }; x <= x1; ++x) {
+			if (row[x] >= 0) {
+				fn(static_cast<unsigned int>(row[x]));
+			}
+		}
+	}
+}
+
+#endif // !GAMELEVEL_H
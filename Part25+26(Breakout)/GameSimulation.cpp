@@ -0,0 +1,565 @@
+#include "GameSimulation.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+const glm::vec2 PLAYER_SIZE{ 100.f, 20.f };
+const float PLAYER_VELOCITY{ 400.f };
+
+const glm::vec2 INIT_BALL_VELOCITY{ 100.f,-350.f };
+const float BALL_RADIUS{ 12.5f };
+
+//one destroyed brick in this many drops a power-up
+const unsigned int POWERUP_CHANCE{ 8 };
+const glm::vec2 POWERUP_SIZE{ 60.f, 20.f };
+const glm::vec2 POWERUP_VELOCITY{ 0.f, 150.f };
+const float GROW_WIDTH{ 50.f };
+
+//contacts the ball may resolve in one tick before it waits out the rest of it
+const int MAX_SWEEP_ITERATIONS{ 8 };
+
+GameSimulation::GameSimulation(unsigned int Width, unsigned int Height)
+	: width(Width), height(Height), Levels(Width, Height / 2)
+{
+	State.state = GAME_MENU;
+	State.level = 0;
+	State.lives = 3;
+	State.speedMod = 1.0f;
+	Events.reserve(64);
+	State.Balls.clear();
+	State.Balls.Radius = BALL_RADIUS;
+	State.PowerUps.clear();
+	State.ActiveEffects.clear();
+	State.effectSpeed = 1.f;
+	State.Random = 1;
+}
+
+unsigned int GameSimulation::addLevel(const char* file) {
+	return Levels.add(file);
+}
+
+void GameSimulation::Init(unsigned int seed) {
+	//xorshift gets stuck at 0
+	State.Random = seed ? seed : 1;
+	State.lives = 3;
+	State.speedMod = 1.0f;
+
+	glm::vec2 playerPos{ width / 2.f - PLAYER_SIZE.x / 2.f, height - PLAYER_SIZE.y };
+	State.Player = GameObject{ playerPos, PLAYER_SIZE };
+
+	glm::vec2 ballPos{playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f, -BALL_RADIUS)};
+	State.Balls.clear();
+	State.Balls.add(ballPos, INIT_BALL_VELOCITY, true);
+	clearPowerUps();
+
+	if (State.level < Levels.size()) {
+		Levels.prefetch(State.level);
+	}
+}
+
+void GameSimulation::resetPlayer() {
+	State.Player.Position = glm::vec2(width / 2.f - PLAYER_SIZE.x / 2.f, height - PLAYER_SIZE.y);
+
+	//back to a single ball on the paddle; it keeps the velocity of the first ball in play
+	glm::vec2 velocity = State.Balls.Count > 0 ? State.Balls.velocity(0) : INIT_BALL_VELOCITY;
+	State.Balls.clear();
+	clearPowerUps();
+	State.Balls.add(State.Player.Position + glm::vec2(PLAYER_SIZE.x / 2.0f, -BALL_RADIUS), velocity, true);
+	State.speedMod = 1.025f;
+
+	Events.push_back(SimEvent{ EVENT_PLAYER_RESET, State.Player.Position });
+}
+
+bool GameSimulation::spawnBall(glm::vec2 center, glm::vec2 velocity) {
+	return State.Balls.add(center, velocity, false);
+}
+
+void GameSimulation::resetLevel() {
+	Levels[State.level].Bricks.resetDestroyed();
+	State.lives = 3;
+	State.speedMod = 1.0f;
+
+	Events.push_back(SimEvent{ EVENT_LEVEL_RESET, glm::vec2(0.f) });
+}
+
+unsigned int GameSimulation::nextRandom() {
+	State.Random ^= State.Random << 13;
+	State.Random ^= State.Random >> 17;
+	State.Random ^= State.Random << 5;
+	return State.Random;
+}
+
+void GameSimulation::dropPowerUp(glm::vec2 brickMin) {
+	if (nextRandom() % POWERUP_CHANCE != 0) {
+		return;
+	}
+	PowerUpType type = static_cast<PowerUpType>(nextRandom() % POWERUP_TYPES);
+	PowerUp* powerUp = State.PowerUps.acquire();
+	if (!powerUp) {
+		return;
+	}
+	powerUp->Type = type;
+	powerUp->Object = GameObject(brickMin, POWERUP_SIZE, powerUpColor(type), POWERUP_VELOCITY);
+	Events.push_back(SimEvent{ EVENT_POWERUP_SPAWNED, brickMin });
+}
+
+void GameSimulation::updatePowerUps(float dt) {
+	//backwards, releasing moves the last live item into the released place
+	PowerUpPool& powerUps = State.PowerUps;
+	for (unsigned int i{ powerUps.Count }; i-- > 0; ) {
+		GameObject& object = powerUps.live(i).Object;
+		object.Position += object.Velocity * dt;
+		if (checkCollision(State.Player, object)) {
+			Events.push_back(SimEvent{ EVENT_POWERUP_ACTIVATED, object.Position });
+			activatePowerUp(powerUps.live(i).Type);
+			powerUps.releaseLive(i);
+		}
+		else if (object.Position.y >= height) {
+			powerUps.releaseLive(i);
+		}
+	}
+
+	EffectPool& effects = State.ActiveEffects;
+	for (unsigned int i{ effects.Count }; i-- > 0; ) {
+		ActiveEffect& effect = effects.live(i);
+		effect.Remaining -= dt;
+		if (effect.Remaining <= 0.f) {
+			applyEffect(effect.Type, false);
+			Events.push_back(SimEvent{ EVENT_POWERUP_EXPIRED, State.Player.Position });
+			effects.releaseLive(i);
+		}
+	}
+}
+
+void GameSimulation::activatePowerUp(PowerUpType type) {
+	if (type == POWERUP_MULTI_BALL) {
+		//two more balls off the first one, angled out to either side
+		if (State.Balls.Count == 0) {
+			return;
+		}
+		glm::vec2 center = State.Balls.center(0);
+		glm::vec2 velocity = State.Balls.velocity(0);
+		float c = std::cos(0.4f), s = std::sin(0.4f);
+		spawnBall(center, glm::vec2(velocity.x * c - velocity.y * s, velocity.x * s + velocity.y * c));
+		spawnBall(center, glm::vec2(velocity.x * c + velocity.y * s, -velocity.x * s + velocity.y * c));
+		return;
+	}
+	EffectPool& effects = State.ActiveEffects;
+	for (unsigned int i{ 0 }; i < effects.Count; ++i) {
+		if (effects.live(i).Type == type) {
+			effects.live(i).Remaining = powerUpDuration(type);
+			return;
+		}
+	}
+	ActiveEffect* effect = effects.acquire();
+	if (effect) {
+		*effect = ActiveEffect{ type, powerUpDuration(type) };
+		applyEffect(type, true);
+	}
+}
+
+bool GameSimulation::hasEffect(PowerUpType type) const {
+	for (unsigned int i{ 0 }; i < State.ActiveEffects.Count; ++i) {
+		if (State.ActiveEffects.live(i).Type == type) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void GameSimulation::applyEffect(PowerUpType type, bool on) {
+	switch (type) {
+	case POWERUP_STICKY:
+		State.Player.Color = on ? powerUpColor(type) : glm::vec3(1.f);
+		break;
+	case POWERUP_GROW: {
+		//grows out from the middle, but never past a wall; balls riding the paddle follow
+		//if the wall pushes it over
+		GameObject& player = State.Player;
+		player.Size.x += on ? GROW_WIDTH : -GROW_WIDTH;
+		float centered = player.Position.x - (on ? GROW_WIDTH / 2.f : -GROW_WIDTH / 2.f);
+		player.Position.x = glm::clamp(centered, 0.f, std::max(0.f, width - player.Size.x));
+		for (unsigned int i{ 0 }; i < State.Balls.Count; ++i) {
+			if (State.Balls.Stuck[i]) {
+				State.Balls.X[i] += player.Position.x - centered;
+			}
+		}
+		break;
+	}
+	case POWERUP_SPEED_UP:
+		State.effectSpeed *= on ? 1.3f : 1.f / 1.3f;
+		break;
+	case POWERUP_SLOW_DOWN:
+		State.effectSpeed *= on ? 0.7f : 1.f / 0.7f;
+		break;
+	default:
+		break;
+	}
+}
+
+void GameSimulation::clearPowerUps() {
+	State.PowerUps.clear();
+	State.ActiveEffects.clear();
+	State.Player.Size = PLAYER_SIZE;
+	State.Player.Color = glm::vec3(1.f);
+	State.effectSpeed = 1.f;
+}
+
+void GameSimulation::snapshot(SimSnapshot& out) {
+	std::memcpy(&out.State, &State, sizeof(SimState));
+	if (State.level < Levels.size()) {
+		out.Destroyed = Levels[State.level].Bricks.Destroyed;
+	}
+}
+
+void GameSimulation::restore(const SimSnapshot& in) {
+	std::memcpy(&State, &in.State, sizeof(SimState));
+	if (State.level < Levels.size()) {
+		Levels[State.level].Bricks.Destroyed = in.Destroyed;
+	}
+}
+
+bool GameSimulation::checkCollision(const GameObject& one, const GameObject& two) {
+	bool collisionX = one.Position.x + one.Size.x >= two.Position.x && two.Position.x + two.Size.x >= one.Position.x;
+	bool collisionY = one.Position.y + one.Size.y >= two.Position.y && two.Position.y + two.Size.y >= one.Position.y;
+	return collisionX && collisionY;
+}
+
+void GameSimulation::tick(unsigned int input, float dt) {
+	Events.clear();
+	processInput(input, dt);
+	update(dt);
+}
+
+void GameSimulation::processInput(unsigned int input, float dt) {
+	if (State.state == GAME_ACTIVE) {
+		float velocity = PLAYER_VELOCITY * dt;
+		
+		if (input & INPUT_LEFT)
+		{
+			if (State.Player.Position.x >= 0.0f) {
+				State.Player.Position.x -= velocity;
+				for (unsigned int i{ 0 }; i < State.Balls.Count; ++i) {
+					if (State.Balls.Stuck[i]) {
+						State.Balls.X[i] -= velocity;
+					}
+				}
+			}
+		}
+		if (input & INPUT_RIGHT)
+		{
+			if (State.Player.Position.x <= width - State.Player.Size.x){
+				State.Player.Position.x += velocity;
+				for (unsigned int i{ 0 }; i < State.Balls.Count; ++i) {
+					if (State.Balls.Stuck[i]) {
+						State.Balls.X[i] += velocity;
+					}
+				}
+			}
+		}
+		if (input & INPUT_LAUNCH) {
+			std::fill(State.Balls.Stuck, State.Balls.Stuck + State.Balls.Count, 0);
+		}
+	}
+	else if (State.state == GAME_MENU) {
+		if (input & INPUT_CONFIRM) {
+			State.state = GAME_ACTIVE;
+		}
+		for (unsigned int i{ 0 }; i < 4; i++) {
+			if ((input & (INPUT_LEVEL_1 << i)) && i < Levels.size()) {
+				State.level = i;
+				//get it loading while the player is still on the menu
+				Levels.prefetch(State.level);
+			}
+		}
+	}
+	else if (State.state == GAME_WIN) {
+		if (input & INPUT_CONFIRM) {
+			State.state = GAME_MENU;
+		}
+	}
+}
+
+void GameSimulation::update(float dt) {
+	if (State.state == GAME_ACTIVE) {
+		doCollision(dt);
+		updatePowerUps(dt);
+
+		//balls below the bottom edge are gone; a life is only lost with the last one
+		for (unsigned int i{ 0 }; i < State.Balls.Count; ) {
+			if (State.Balls.Y[i] - State.Balls.Radius < height) {
+				++i;
+			}
+			else if (State.Balls.Count > 1) {
+				State.Balls.remove(i);
+			}
+			else {
+				Events.push_back(SimEvent{ EVENT_BALL_LOST, State.Balls.center(i) - State.Balls.Radius });
+				State.lives--;
+
+				if (State.lives <= 0) {
+					resetLevel();
+					State.state = GAME_MENU;
+				}
+				resetPlayer();
+				break;
+			}
+		}
+
+		if (Levels[State.level].isCompleted()) {
+			resetLevel();
+			resetPlayer();
+			State.state = GAME_WIN;
+		}
+	}
+}
+
+//earliest t in [0, maxT] at which origin + vel * t enters [min, max]
+static bool sweepRayAABB(glm::vec2 origin, glm::vec2 vel, glm::vec2 min, glm::vec2 max, float maxT, float& t) {
+	float tEnter = 0.f, tExit = maxT;
+	for (int axis{ 0 }; axis < 2; ++axis) {
+		if (vel[axis] == 0.f) {
+			if (origin[axis] < min[axis] || origin[axis] > max[axis]) {
+				return false;
+			}
+			continue;
+		}
+		float t0 = (min[axis] - origin[axis]) / vel[axis];
+		float t1 = (max[axis] - origin[axis]) / vel[axis];
+		if (t0 > t1) std::swap(t0, t1);
+		tEnter = std::max(tEnter, t0);
+		tExit = std::min(tExit, t1);
+		if (tEnter > tExit) {
+			return false;
+		}
+	}
+	//touching the boundary on the way out isn't a hit
+	if (tExit <= 0.f) {
+		return false;
+	}
+	t = tEnter;
+	return true;
+}
+
+//earliest t in [0, maxT] at which origin + vel * t is within radius of center
+static bool sweepRayCircle(glm::vec2 origin, glm::vec2 vel, glm::vec2 center, float radius, float maxT, float& t) {
+	glm::vec2 m = origin - center;
+	float a = glm::dot(vel, vel);
+	float b = glm::dot(m, vel);
+	float c = glm::dot(m, m) - radius * radius;
+	if (a == 0.f || b > 0.f) {
+		return false;
+	}
+	float disc = b * b - a * c;
+	if (disc < 0.f) {
+		return false;
+	}
+	float hit = (-b - std::sqrt(disc)) / a;
+	if (hit > maxT) {
+		return false;
+	}
+	t = std::max(hit, 0.f);
+	return true;
+}
+
+bool GameSimulation::sweepCircleAABB(glm::vec2 center, glm::vec2 vel, float radius, glm::vec2 min, glm::vec2 max, float maxT, float& t, glm::vec2& normal) {
+	glm::vec2 closest = glm::clamp(center, min, max);
+	glm::vec2 offset = center - closest;
+	float distSq = glm::dot(offset, offset);
+	if (distSq < radius * radius) {
+		//already overlapping: only counts if we're still heading further in
+		if (distSq > 0.f) {
+			if (glm::dot(vel, offset) >= 0.f) {
+				return false;
+			}
+			normal = offset / std::sqrt(distSq);
+		}
+		else {
+			normal = glm::length(vel) > 0.f ? -glm::normalize(vel) : glm::vec2(0.f, -1.f);
+		}
+		t = 0.f;
+		return true;
+	}
+
+	//the box grown by the radius is the union of two slabs and four corner circles
+	float best = maxT;
+	bool hit = false;
+	float candidate;
+	if (sweepRayAABB(center, vel, glm::vec2(min.x - radius, min.y), glm::vec2(max.x + radius, max.y), best, candidate)) {
+		best = candidate;
+		hit = true;
+	}
+	if (sweepRayAABB(center, vel, glm::vec2(min.x, min.y - radius), glm::vec2(max.x, max.y + radius), best, candidate)) {
+		best = candidate;
+		hit = true;
+	}
+	glm::vec2 corners[]{ min, glm::vec2(max.x, min.y), glm::vec2(min.x, max.y), max };
+	for (const glm::vec2& corner : corners) {
+		if (sweepRayCircle(center, vel, corner, radius, best, candidate)) {
+			best = candidate;
+			hit = true;
+		}
+	}
+	if (!hit) {
+		return false;
+	}
+	glm::vec2 contact = center + vel * best;
+	offset = contact - glm::clamp(contact, min, max);
+	normal = glm::length(offset) > 0.f ? glm::normalize(offset) : -glm::normalize(vel);
+	t = best;
+	return true;
+}
+
+void GameSimulation::doCollision(float dt) {
+	for (unsigned int i{ 0 }; i < State.Balls.Count; ++i) {
+		if (!State.Balls.Stuck[i]) {
+			sweepBall(i, dt);
+		}
+	}
+}
+
+void GameSimulation::sweepBall(unsigned int ball, float dt) {
+	BrickStore& bricks = Levels[State.level].Bricks;
+	const float radius = State.Balls.Radius;
+
+	//advance the ball contact by contact: find the earliest thing it touches in the time
+	//left, move it there, bounce, and go again until the tick is used up or we run out
+	//of iterations (then the ball just waits out the rest of the tick)
+	float remaining = dt;
+	for (int iteration{ 0 }; iteration < MAX_SWEEP_ITERATIONS && remaining > 0.f; ++iteration) {
+		glm::vec2 center = State.Balls.center(ball);
+		glm::vec2 vel = State.Balls.velocity(ball) * (State.speedMod * State.effectSpeed);
+		glm::vec2 end = center + vel * remaining;
+
+		enum { HIT_NONE, HIT_WALL, HIT_BRICK, HIT_PADDLE } hitType = HIT_NONE;
+		float hitTime = remaining;
+		glm::vec2 hitNormal{ 0.f };
+		unsigned int hitBrick = 0;
+
+		//window edges, except the bottom one
+		if (vel.x < 0.f && center.x - radius + vel.x * hitTime <= 0.f) {
+			hitTime = std::max(0.f, (radius - center.x) / vel.x);
+			hitNormal = glm::vec2(1.f, 0.f);
+			hitType = HIT_WALL;
+		}
+		else if (vel.x > 0.f && center.x + radius + vel.x * hitTime >= width) {
+			hitTime = std::max(0.f, (width - radius - center.x) / vel.x);
+			hitNormal = glm::vec2(-1.f, 0.f);
+			hitType = HIT_WALL;
+		}
+		if (vel.y < 0.f && center.y - radius + vel.y * hitTime <= 0.f) {
+			float t = std::max(0.f, (radius - center.y) / vel.y);
+			if (hitType == HIT_NONE || t < hitTime) {
+				hitTime = t;
+				hitNormal = glm::vec2(0.f, 1.f);
+				hitType = HIT_WALL;
+			}
+		}
+
+		//only bricks in the tiles covered by the rest of this tick's movement can be hit;
+		//gather them and test them all in one batch
+		glm::vec2 sweepMin = glm::min(center, end) - radius;
+		glm::vec2 sweepMax = glm::max(center, end) + radius;
+		sweepBoxes.clear();
+		Levels[State.level].queryArea(sweepMin, sweepMax, [&](unsigned int i) {
+			if (!bricks.isDestroyed(i)) {
+				sweepBoxes.push(i, bricks.Min[i], bricks.Max[i]);
+			}
+		});
+		if (sweepBoxes.size() > 0) {
+			sweepTimes.resize(sweepBoxes.size());
+			float maxT = hitTime;
+			sweepCircleBoxes(center, vel, radius, maxT, sweepBoxes, sweepTimes.data());
+			//first earliest in query order, same as testing them one at a time
+			bool brickHit = false;
+			float brickTime = hitTime;
+			unsigned int brick = 0;
+			for (unsigned int k{ 0 }; k < sweepBoxes.size(); ++k) {
+				float t = sweepTimes[k];
+				if (t >= 0.f && ((hitType == HIT_NONE && !brickHit) || t < brickTime)) {
+					brickTime = t;
+					brick = sweepBoxes.Index[k];
+					brickHit = true;
+				}
+			}
+			//the batch only gives times; the normal comes from testing that one brick again,
+			//and if that test disagrees the brick is left for the next iteration rather than
+			//bouncing off a normal we don't have
+			float t;
+			glm::vec2 normal;
+			if (brickHit && sweepCircleAABB(center, vel, radius, bricks.Min[brick], bricks.Max[brick], maxT, t, normal)) {
+				hitTime = brickTime;
+				hitNormal = normal;
+				hitBrick = brick;
+				hitType = HIT_BRICK;
+			}
+		}
+
+		{
+			float t;
+			glm::vec2 normal;
+			if (sweepCircleAABB(center, vel, radius, State.Player.Position, State.Player.Position + State.Player.Size, hitTime, t, normal)) {
+				if (hitType == HIT_NONE || t < hitTime) {
+					hitTime = t;
+					hitNormal = normal;
+					hitType = HIT_PADDLE;
+				}
+			}
+		}
+
+		State.Balls.X[ball] += vel.x * hitTime;
+		State.Balls.Y[ball] += vel.y * hitTime;
+		remaining -= hitTime;
+		if (hitType == HIT_NONE) {
+			break;
+		}
+
+		glm::vec2 velocity = State.Balls.velocity(ball);
+		if (hitType == HIT_PADDLE) {
+			Events.push_back(SimEvent{ EVENT_PADDLE_HIT, State.Balls.center(ball) - radius });
+			float centerBoard = State.Player.Position.x + State.Player.Size.x/2.0f;
+			float distance = (State.Balls.X[ball] + radius) - centerBoard;
+			float percent = distance / (State.Player.Size.x/2.0f);
+
+			float strength = 2.f;
+			glm::vec2 oldVelocity = velocity;
+			velocity.x = INIT_BALL_VELOCITY.x * percent * strength;
+			velocity.y = -1.0f * std::abs(velocity.y);
+			velocity = glm::normalize(velocity) * glm::length(oldVelocity);
+			State.Balls.VelX[ball] = velocity.x;
+			State.Balls.VelY[ball] = velocity.y;
+			//the paddle isn't swept, so it can slide right over the ball; lift the ball back
+			//on top or it stays inside, gets a hit at t=0 every iteration and never leaves
+			State.Balls.Y[ball] = std::min(State.Balls.Y[ball], State.Player.Position.y - radius);
+			if (hasEffect(POWERUP_STICKY)) {
+				//rides the paddle until launched, leaving with the velocity it bounced off with
+				State.Balls.Stuck[ball] = 1;
+				break;
+			}
+			continue;
+		}
+
+		if (hitType == HIT_BRICK) {
+			if (!bricks.isSolid(hitBrick)) {
+				bricks.destroy(hitBrick);
+				Events.push_back(SimEvent{ EVENT_BRICK_DESTROYED, bricks.Min[hitBrick], hitBrick });
+				State.speedMod += 0.025;
+				dropPowerUp(bricks.Min[hitBrick]);
+				if (hasEffect(POWERUP_PASS_THROUGH)) {
+					continue;
+				}
+			}
+			else {
+				Events.push_back(SimEvent{ EVENT_SOLID_HIT, bricks.Min[hitBrick], hitBrick });
+			}
+		}
+		//reflect off whatever we touched, but only if we're actually heading into it
+		float into = glm::dot(velocity, hitNormal);
+		if (into < 0.f) {
+			velocity -= 2.f * into * hitNormal;
+			State.Balls.VelX[ball] = velocity.x;
+			State.Balls.VelY[ball] = velocity.y;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#ifndef GAME_SIMULATION_H
+#define GAME_SIMULATION_H
+#include <vector>
+#include <type_traits>
+#include <glm/glm.hpp>
+
+#include "GameLevel.h"
+#include "LevelCatalog.h"
+#include "game_object.h"
+#include "BallSet.h"
+#include "SweepKernel.h"
+#include "PowerUp.h"
+
+//everything in here is plain game state and logic: no GL, no GLFW, no audio,
+//so it can be stepped on machines without a window or a sound card
+
+enum GameState {
+	GAME_ACTIVE,
+	GAME_MENU,
+	GAME_WIN
+};
+
+//one bit per button held during a tick
+enum InputFlags : unsigned int {
+	INPUT_LEFT = 1 << 0,
+	INPUT_RIGHT = 1 << 1,
+	INPUT_LAUNCH = 1 << 2,
+	INPUT_CONFIRM = 1 << 3,
+	INPUT_LEVEL_1 = 1 << 4, //INPUT_LEVEL_1 << n selects level n
+};
+
+//things that happened during a tick that the presentation layer may want to react to
+enum SimEventType {
+	EVENT_BRICK_DESTROYED,
+	EVENT_SOLID_HIT,
+	EVENT_PADDLE_HIT,
+	EVENT_BALL_LOST,
+	EVENT_PLAYER_RESET,
+	EVENT_POWERUP_SPAWNED,
+	EVENT_POWERUP_ACTIVATED,
+	EVENT_POWERUP_EXPIRED,
+	EVENT_LEVEL_RESET //every brick in the current level is back
+};
+
+struct SimEvent {
+	SimEventType type;
+	glm::vec2 position;
+	//brick events: index into the current level's Bricks
+	unsigned int brick{ 0 };
+};
+
+//everything a tick changes apart from the bricks, kept in one trivially copyable block
+//so saving or restoring it is a single memcpy
+struct SimState {
+	GameState state;
+	unsigned int level;
+	unsigned int lives;
+	float speedMod;
+
+	GameObject Player;
+	BallSet Balls;
+
+	PowerUpPool PowerUps;
+	EffectPool ActiveEffects;
+	//ball speed from speed power-ups, on top of speedMod
+	float effectSpeed;
+	//xorshift state for power-up drops; kept here so snapshots and replays see the same drops
+	unsigned int Random;
+};
+static_assert(std::is_trivially_copyable<SimState>::value, "SimState has to stay memcpy-able");
+
+//a saved simulation: the state block and the destroyed bits of the level being played.
+//The bits share pages with the live level until one side writes to them, so taking a
+//snapshot costs one memcpy plus a reference per page of bricks
+struct SimSnapshot {
+	SimState State;
+	BitPages Destroyed;
+};
+
+class GameSimulation {
+public:
+	unsigned int width, height;
+
+	LevelCatalog Levels;
+	SimState State;
+
+	//cleared at the start of every tick
+	std::vector<SimEvent> Events;
+
+	GameSimulation(unsigned int Width, unsigned int Height);
+
+	//adds a level file, sized to the top half of the play field; it's loaded when first
+	//selected or played. Returns the level's index
+	unsigned int addLevel(const char* file);
+	//puts the paddle and ball in their starting positions; seed picks the power-up drops
+	void Init(unsigned int seed = 1);
+
+	//forking: restore() puts the simulation back exactly as it was at snapshot(), so the
+	//same inputs give the same ticks from there; both are cheap enough to do per tick.
+	//Only the current level's bricks are saved, switching levels in between isn't undone
+	void snapshot(SimSnapshot& out);
+	void restore(const SimSnapshot& in);
+
+	void tick(unsigned int input, float dt);
+	void processInput(unsigned int input, float dt);
+	void update(float dt);
+
+	//adds a free ball, e.g. for multi-ball; false if there's no room left
+	bool spawnBall(glm::vec2 center, glm::vec2 velocity);
+
+	//moves every ball through dt, resolving contacts in the order they happen
+	void doCollision(float dt);
+	void sweepBall(unsigned int i, float dt);
+	//earliest t in [0, maxT] at which a circle moving with vel touches [min, max], and the contact normal
+	static bool sweepCircleAABB(glm::vec2 center, glm::vec2 vel, float radius, glm::vec2 min, glm::vec2 max, float maxT, float& t, glm::vec2& normal);
+	//AABB overlap, touching edges included
+	static bool checkCollision(const GameObject& one, const GameObject& two);
+
+	void resetPlayer();
+	void resetLevel();
+
+	//rolls for a power-up out of a destroyed brick
+	void dropPowerUp(glm::vec2 brickMin);
+	//moves falling power-ups, picks up the ones the paddle touches and runs effect timers
+	void updatePowerUps(float dt);
+	void activatePowerUp(PowerUpType type);
+	bool hasEffect(PowerUpType type) const;
+	//drops everything falling and undoes every running effect
+	void clearPowerUps();
+private:
+	//scratch for sweepBall, kept around so it doesn't allocate every tick
+	SweepBoxes sweepBoxes;
+	std::vector<float> sweepTimes;
+
+	void applyEffect(PowerUpType type, bool on);
+	unsigned int nextRandom();
+};
+
+#endif
@@ -0,0 +1,251 @@
+#include "InputRecording.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const char RECORDING_MAGIC[4]{ 'B', 'R', 'E', 'C' };
+static const unsigned int RECORDING_VERSION{ 2 };
+
+static void writeVarint(std::vector<unsigned char>& out, unsigned long long value) {
+	while (value >= 0x80) {
+		out.push_back(static_cast<unsigned char>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<unsigned char>(value));
+}
+
+static unsigned long long readVarint(const std::vector<unsigned char>& in, size_t& offset) {
+	unsigned long long value = 0;
+	for (int shift{ 0 }; offset < in.size() && shift < 64; shift += 7) {
+		unsigned char byte = in[offset++];
+		value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			break;
+		}
+	}
+	return value;
+}
+
+//header fields are little endian whatever the host is; floats go as their bit pattern
+static void writeU64(std::ofstream& out, unsigned long long v, unsigned int bytes = 8) {
+	unsigned char b[8];
+	for (unsigned int i{ 0 }; i < bytes; ++i) {
+		b[i] = static_cast<unsigned char>(v >> (8 * i));
+	}
+	out.write(reinterpret_cast<const char*>(b), bytes);
+}
+static void writeU32(std::ofstream& out, unsigned int v) { writeU64(out, v, 4); }
+static void writeF32(std::ofstream& out, float v) {
+	unsigned int bits;
+	std::memcpy(&bits, &v, 4);
+	writeU32(out, bits);
+}
+
+static bool readU64(std::ifstream& in, unsigned long long& v, unsigned int bytes = 8) {
+	unsigned char b[8];
+	if (!in.read(reinterpret_cast<char*>(b), bytes)) {
+		return false;
+	}
+	v = 0;
+	for (unsigned int i{ 0 }; i < bytes; ++i) {
+		v |= static_cast<unsigned long long>(b[i]) << (8 * i);
+	}
+	return true;
+}
+static bool readU32(std::ifstream& in, unsigned int& v) {
+	unsigned long long wide;
+	if (!readU64(in, wide, 4)) {
+		return false;
+	}
+	v = static_cast<unsigned int>(wide);
+	return true;
+}
+static bool readF32(std::ifstream& in, float& v) {
+	unsigned int bits;
+	if (!readU32(in, bits)) {
+		return false;
+	}
+	std::memcpy(&v, &bits, 4);
+	return true;
+}
+
+bool InputRecording::save(const char* file) const {
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		std::cout << "ERROR::RECORDING: Failed to open " << file << " for writing" << std::endl;
+		return false;
+	}
+	out.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+	writeU32(out, RECORDING_VERSION);
+	writeF32(out, tick);
+	writeU32(out, width);
+	writeU32(out, height);
+	writeU32(out, startLevel);
+	writeU32(out, seed);
+	writeU32(out, static_cast<unsigned int>(levels.size()));
+	for (const std::string& level : levels) {
+		writeU32(out, static_cast<unsigned int>(level.size()));
+		out.write(level.data(), level.size());
+	}
+	writeU64(out, ticks);
+	writeU64(out, finalHash);
+	writeU32(out, changeCount);
+	out.write(reinterpret_cast<const char*>(changes.data()), changes.size());
+	return (bool)out;
+}
+
+bool InputRecording::load(const char* file) {
+	std::ifstream in(file, std::ios::binary);
+	char magic[4];
+	unsigned int version, levelCount;
+	if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0
+		|| !readU32(in, version)) {
+		std::cout << "ERROR::RECORDING: " << file << " is not a recording" << std::endl;
+		return false;
+	}
+	//older versions don't play back the same, e.g. 1 had no power-ups
+	if (version != RECORDING_VERSION) {
+		std::cout << "ERROR::RECORDING: " << file << " is version " << version << ", this build plays version " << RECORDING_VERSION << std::endl;
+		return false;
+	}
+	if (!readF32(in, tick) || !readU32(in, width) || !readU32(in, height)
+		|| !readU32(in, startLevel) || !readU32(in, seed) || !readU32(in, levelCount)) {
+		return false;
+	}
+	levels.resize(levelCount);
+	for (std::string& level : levels) {
+		unsigned int length;
+		if (!readU32(in, length)) {
+			return false;
+		}
+		level.resize(length);
+		if (length > 0 && !in.read(&level[0], length)) {
+			return false;
+		}
+	}
+	if (!readU64(in, ticks) || !readU64(in, finalHash) || !readU32(in, changeCount)) {
+		return false;
+	}
+	changes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	return true;
+}
+
+void InputRecording::setup(GameSimulation& sim) const {
+	for (const std::string& level : levels) {
+		sim.addLevel(level.c_str());
+	}
+	sim.State.level = startLevel;
+	sim.Init(seed);
+}
+
+static void hashBytes(unsigned long long& hash, const void* data, size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i{ 0 }; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+
+unsigned long long hashState(GameSimulation& sim) {
+	unsigned long long hash = 14695981039346656037ull;
+	unsigned int header[]{ (unsigned int)sim.State.state, sim.State.level, sim.State.lives };
+	hashBytes(hash, header, sizeof(header));
+	hashBytes(hash, &sim.State.speedMod, sizeof(sim.State.speedMod));
+	hashBytes(hash, &sim.State.Player.Position, sizeof(sim.State.Player.Position));
+	hashBytes(hash, &sim.State.Player.Size, sizeof(sim.State.Player.Size));
+
+	const BallSet& balls = sim.State.Balls;
+	hashBytes(hash, &balls.Count, sizeof(balls.Count));
+	hashBytes(hash, balls.X, balls.Count * sizeof(float));
+	hashBytes(hash, balls.Y, balls.Count * sizeof(float));
+	hashBytes(hash, balls.VelX, balls.Count * sizeof(float));
+	hashBytes(hash, balls.VelY, balls.Count * sizeof(float));
+	hashBytes(hash, balls.Stuck, balls.Count);
+
+	hashBytes(hash, &sim.State.effectSpeed, sizeof(sim.State.effectSpeed));
+	hashBytes(hash, &sim.State.Random, sizeof(sim.State.Random));
+	const PowerUpPool& powerUps = sim.State.PowerUps;
+	for (unsigned int i{ 0 }; i < powerUps.Count; ++i) {
+		hashBytes(hash, &powerUps.live(i).Type, sizeof(PowerUpType));
+		hashBytes(hash, &powerUps.live(i).Object.Position, sizeof(glm::vec2));
+	}
+	const EffectPool& effects = sim.State.ActiveEffects;
+	for (unsigned int i{ 0 }; i < effects.Count; ++i) {
+		hashBytes(hash, &effects.live(i), sizeof(ActiveEffect));
+	}
+
+	if (sim.State.level < sim.Levels.size()) {
+		const BrickStore& bricks = sim.Levels[sim.State.level].Bricks;
+		for (unsigned int w{ 0 }; w < bricks.SolidBits.size(); ++w) {
+			unsigned long long word{ bricks.Destroyed.word(w) };
+			hashBytes(hash, &word, sizeof(word));
+		}
+	}
+	return hash;
+}
+
+InputRecorder::InputRecorder()
+	: recording(false), lastInput(0), lastChange(0)
+{
+}
+
+void InputRecorder::begin(const GameSimulation& sim, float tick) {
+	session = InputRecording();
+	session.tick = tick;
+	session.width = sim.width;
+	session.height = sim.height;
+	session.startLevel = sim.State.level;
+	session.seed = sim.State.Random;
+	for (unsigned int i{ 0 }; i < sim.Levels.size(); ++i) {
+		session.levels.push_back(sim.Levels.file(i));
+	}
+	session.ticks = 0;
+	session.finalHash = 0;
+	session.changeCount = 0;
+	recording = true;
+	lastInput = 0;
+	lastChange = 0;
+}
+
+void InputRecorder::record(unsigned int input) {
+	if (input != lastInput) {
+		writeVarint(session.changes, session.ticks - lastChange);
+		writeVarint(session.changes, input);
+		session.changeCount++;
+		lastInput = input;
+		lastChange = session.ticks;
+	}
+	session.ticks++;
+}
+
+bool InputRecorder::save(const char* file, GameSimulation& sim) {
+	session.finalHash = hashState(sim);
+	return session.save(file);
+}
+
+InputPlayer::InputPlayer(const InputRecording& recording)
+	: recording(recording), offset(0), tick(0), nextChange(0), input(0), pendingInput(0)
+{
+	readChange();
+}
+
+void InputPlayer::readChange() {
+	if (offset < recording.changes.size()) {
+		nextChange = tick + readVarint(recording.changes, offset);
+		pendingInput = static_cast<unsigned int>(readVarint(recording.changes, offset));
+	}
+	else {
+		nextChange = ~0ull;
+	}
+}
+
+unsigned int InputPlayer::next() {
+	//a change recorded at tick t applies from tick t on
+	while (tick == nextChange) {
+		input = pendingInput;
+		readChange();
+	}
+	tick++;
+	return input;
+}
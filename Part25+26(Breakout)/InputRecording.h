@@ -0,0 +1,72 @@
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+#include <string>
+#include <vector>
+
+#include "GameSimulation.h"
+
+//a play session as the input flags of every tick, enough to re-run it exactly since the
+//simulation is deterministic. Only ticks where the input changes are stored.
+//
+//.rec layout (little endian):
+//  char[4] "BREC", uint32 version, float tick, uint32 width, uint32 height,
+//  uint32 startLevel, uint32 seed, uint32 levelCount, levelCount x { uint32 length, char path[length] },
+//  uint64 ticks, uint64 finalHash, uint32 changeCount,
+//  changeCount x { varint ticksSincePreviousChange, varint input }
+//varints are 7 bits a byte, low bits first, high bit set on every byte but the last
+
+struct InputRecording {
+	float tick;
+	unsigned int width, height;
+	unsigned int startLevel;
+	//what GameSimulation::Init was given, it decides the power-up drops
+	unsigned int seed;
+	std::vector<std::string> levels;
+	unsigned long long ticks;
+	unsigned long long finalHash;
+	//varint-encoded changes, see above
+	std::vector<unsigned char> changes;
+	unsigned int changeCount;
+
+	bool save(const char* file) const;
+	bool load(const char* file);
+	//a simulation set up the way the recorded one started
+	void setup(GameSimulation& sim) const;
+};
+
+//FNV-1a over everything that decides what happens next: game state, paddle, balls,
+//power-ups and the current level's bricks
+unsigned long long hashState(GameSimulation& sim);
+
+class InputRecorder {
+public:
+	InputRecorder();
+	bool active() const { return recording; }
+	//call before the first tick, with the simulation as it is then
+	void begin(const GameSimulation& sim, float tick);
+	void record(unsigned int input);
+	//stamps the final state hash and writes the session out
+	bool save(const char* file, GameSimulation& sim);
+private:
+	InputRecording session;
+	bool recording;
+	unsigned int lastInput;
+	unsigned long long lastChange;
+};
+
+//plays a recording's inputs back one tick at a time
+class InputPlayer {
+public:
+	InputPlayer(const InputRecording& recording);
+	bool done() const { return tick >= recording.ticks; }
+	unsigned int next();
+private:
+	const InputRecording& recording;
+	size_t offset;
+	unsigned long long tick, nextChange;
+	unsigned int input, pendingInput;
+
+	void readChange();
+};
+
+#endif
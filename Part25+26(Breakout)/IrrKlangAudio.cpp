@@ -0,0 +1,54 @@
+#include "IrrKlangAudio.h"
+
+#include <iostream>
+
+using namespace irrklang;
+
+IrrKlangAudioBackend::IrrKlangAudioBackend()
+	: engine(createIrrKlangDevice()), voices()
+{
+	if (!engine) {
+		std::cout << "ERROR::AUDIO: Could not start irrKlang, running without sound" << std::endl;
+	}
+}
+
+IrrKlangAudioBackend::~IrrKlangAudioBackend() {
+	for (unsigned int v{ 0 }; v < MAX_VOICES; ++v) {
+		release(v);
+	}
+	if (engine) {
+		engine->drop();
+	}
+}
+
+bool IrrKlangAudioBackend::load(unsigned int sound, const std::string& file) {
+	if (sources.size() <= sound) {
+		sources.resize(sound + 1, nullptr);
+	}
+	//decode up front so starting a sound never touches the disk
+	sources[sound] = engine ? engine->addSoundSourceFromFile(file.c_str(), ESM_NO_STREAMING, true) : nullptr;
+	return sources[sound] != nullptr;
+}
+
+void IrrKlangAudioBackend::release(unsigned int voice) {
+	if (voices[voice]) {
+		voices[voice]->stop();
+		voices[voice]->drop();
+		voices[voice] = nullptr;
+	}
+}
+
+void IrrKlangAudioBackend::start(unsigned int voice, unsigned int sound, float volume) {
+	release(voice);
+	if (sound < sources.size() && sources[sound]) {
+		voices[voice] = engine->play2D(sources[sound], false, true, true);
+		if (voices[voice]) {
+			voices[voice]->setVolume(volume);
+			voices[voice]->setIsPaused(false);
+		}
+	}
+}
+
+bool IrrKlangAudioBackend::playing(unsigned int voice) {
+	return voices[voice] && !voices[voice]->isFinished();
+}
@@ -0,0 +1,26 @@
+#ifndef IRRKLANG_AUDIO_H
+#define IRRKLANG_AUDIO_H
+#include <vector>
+#include <irrKlang/irrKlang.h>
+
+#include "AudioSystem.h"
+
+//plays through irrKlang: sounds are preloaded as sound sources, and each voice is a
+//tracked ISound we can check on and stop
+class IrrKlangAudioBackend : public AudioBackend {
+public:
+	IrrKlangAudioBackend();
+	~IrrKlangAudioBackend();
+
+	bool load(unsigned int sound, const std::string& file) override;
+	void start(unsigned int voice, unsigned int sound, float volume) override;
+	bool playing(unsigned int voice) override;
+private:
+	irrklang::ISoundEngine* engine;
+	std::vector<irrklang::ISoundSource*> sources;
+	irrklang::ISound* voices[MAX_VOICES];
+
+	void release(unsigned int voice);
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "LevelCatalog.h"
+
+LevelCatalog::LevelCatalog(unsigned int levelWidth, unsigned int levelHeight)
+	: levelWidth(levelWidth), levelHeight(levelHeight)
+{
+}
+
+unsigned int LevelCatalog::add(const std::string& file) {
+	slots.emplace_back();
+	slots.back().file = file;
+	slots.back().state = SLOT_UNLOADED;
+	return size() - 1;
+}
+
+unsigned int LevelCatalog::add(const std::string& file, const GameLevel& level) {
+	slots.emplace_back();
+	slots.back().file = file;
+	slots.back().level = level;
+	slots.back().state = SLOT_LOADED;
+	return size() - 1;
+}
+
+void LevelCatalog::prefetch(unsigned int i) {
+	Slot& slot = slots[i];
+	if (slot.state != SLOT_UNLOADED) {
+		return;
+	}
+	std::string file = slot.file;
+	unsigned int w = levelWidth, h = levelHeight;
+	slot.pending = std::async(std::launch::async, [file, w, h]() {
+		GameLevel level;
+		level.load(file.c_str(), w, h);
+		return level;
+	});
+	slot.state = SLOT_LOADING;
+}
+
+GameLevel* LevelCatalog::ready(unsigned int i) {
+	Slot& slot = slots[i];
+	if (slot.state == SLOT_LOADING && slot.pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		slot.level = slot.pending.get();
+		slot.state = SLOT_LOADED;
+	}
+	return slot.state == SLOT_LOADED ? &slot.level : nullptr;
+}
+
+void LevelCatalog::load(unsigned int i) {
+	Slot& slot = slots[i];
+	if (slot.state == SLOT_LOADING) {
+		slot.level = slot.pending.get();
+	}
+	else {
+		slot.level.load(slot.file.c_str(), levelWidth, levelHeight);
+	}
+	slot.state = SLOT_LOADED;
+}
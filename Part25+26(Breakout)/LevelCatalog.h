@@ -0,0 +1,55 @@
+#ifndef LEVEL_CATALOG_H
+#define LEVEL_CATALOG_H
+#include <string>
+#include <vector>
+#include <future>
+
+#include "GameLevel.h"
+
+//a level pack by path: adding a level only records where it lives, and nothing is read
+//until it's wanted. prefetch() loads a level on a background thread so it's usually
+//ready by the time it's played; finished levels are moved into their slot, never copied.
+//Only the thread that owns the catalog touches the slots, the loader threads just
+//hand back a GameLevel through their future.
+class LevelCatalog {
+public:
+	LevelCatalog(unsigned int levelWidth, unsigned int levelHeight);
+
+	//returns the new level's index; references from operator[]/ready() don't survive this
+	unsigned int add(const std::string& file);
+	//same, for a level that's already loaded; the copy shares its brick pages with level
+	unsigned int add(const std::string& file, const GameLevel& level);
+	unsigned int size() const { return static_cast<unsigned int>(slots.size()); }
+	const std::string& file(unsigned int i) const { return slots[i].file; }
+
+	//starts loading level i in the background unless it's loaded or already on its way
+	void prefetch(unsigned int i);
+	//level i if it has finished loading, otherwise nullptr; never blocks
+	GameLevel* ready(unsigned int i);
+	//level i, loading it here or waiting on its background load if it isn't in yet
+	GameLevel& operator[](unsigned int i) {
+		if (slots[i].state != SLOT_LOADED) {
+			load(i);
+		}
+		return slots[i].level;
+	}
+private:
+	enum SlotState {
+		SLOT_UNLOADED,
+		SLOT_LOADING,
+		SLOT_LOADED
+	};
+	struct Slot {
+		std::string file;
+		SlotState state;
+		GameLevel level;
+		std::future<GameLevel> pending;
+	};
+
+	std::vector<Slot> slots;
+	unsigned int levelWidth, levelHeight;
+
+	void load(unsigned int i);
+};
+
+#endif
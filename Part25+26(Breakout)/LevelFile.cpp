@@ -0,0 +1,186 @@
+#include "LevelFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char LEVEL_MAGIC[4]{ 'B', 'L', 'V', 'L' };
+static const unsigned int LEVEL_VERSION{ 1 };
+
+//header words are little endian whatever the host is
+static unsigned int readU32(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24); }
+
+static void writeU32(std::ofstream& out, unsigned int v) {
+	unsigned char b[4]{ (unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24) };
+	out.write(reinterpret_cast<const char*>(b), 4);
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile() : bytes(nullptr), length(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {}
+
+bool MappedFile::open(const char* file) {
+	close();
+	fileHandle = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+		close();
+		return false;
+	}
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle) {
+		close();
+		return false;
+	}
+	bytes = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!bytes) {
+		close();
+		return false;
+	}
+	length = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes) UnmapViewOfFile(bytes);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+	bytes = nullptr;
+	length = 0;
+	mappingHandle = nullptr;
+	fileHandle = INVALID_HANDLE_VALUE;
+}
+#else
+MappedFile::MappedFile() : bytes(nullptr), length(0) {}
+
+bool MappedFile::open(const char* file) {
+	close();
+	int fd = ::open(file, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	//the mapping keeps its own reference to the file, so the descriptor can go straight away
+	void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (mapped == MAP_FAILED) {
+		return false;
+	}
+	bytes = static_cast<const unsigned char*>(mapped);
+	length = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void MappedFile::close() {
+	if (bytes) munmap(const_cast<unsigned char*>(bytes), length);
+	bytes = nullptr;
+	length = 0;
+}
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+bool readLevelHeader(const unsigned char* data, size_t size, unsigned int& columns, unsigned int& rows) {
+	if (size < LEVEL_HEADER_SIZE || std::memcmp(data, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0) {
+		return false;
+	}
+	const unsigned char* words = data + sizeof(LEVEL_MAGIC);
+	unsigned int header[3]{ readU32(words), readU32(words + 4), readU32(words + 8) };
+	if (header[0] != LEVEL_VERSION || header[1] == 0 || header[2] == 0
+		|| (size - LEVEL_HEADER_SIZE) / header[1] < header[2]) {
+		return false;
+	}
+	columns = header[1];
+	rows = header[2];
+	return true;
+}
+
+bool parseLevelText(const char* text, size_t size, std::vector<unsigned char>& tiles, unsigned int& columns, unsigned int& rows) {
+	tiles.clear();
+	columns = 0;
+	rows = 0;
+	const char* end = text + size;
+	const char* p = text;
+	while (p < end) {
+		//one row per line, blank lines are skipped
+		unsigned int count = 0;
+		size_t rowStart = tiles.size();
+		while (p < end && *p != '\n') {
+			if (*p >= '0' && *p <= '9') {
+				unsigned int code = 0;
+				while (p < end && *p >= '0' && *p <= '9') {
+					code = code * 10 + (*p++ - '0');
+				}
+				if (code > 255) {
+					std::cout << "ERROR::LEVEL: Tile code " << code << " out of range" << std::endl;
+					return false;
+				}
+				if (rows == 0 || count < columns) {
+					tiles.push_back(static_cast<unsigned char>(code));
+				}
+				count++;
+			}
+			else {
+				p++;
+			}
+		}
+		p++;
+		if (count == 0) {
+			continue;
+		}
+		if (rows == 0) {
+			columns = count;
+		}
+		tiles.resize(rowStart + columns, 0);
+		rows++;
+	}
+	return rows > 0;
+}
+
+bool writeLevel(const char* file, const std::vector<unsigned char>& tiles, unsigned int columns, unsigned int rows) {
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		std::cout << "ERROR::LEVEL: Failed to open " << file << " for writing" << std::endl;
+		return false;
+	}
+	out.write(LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+	writeU32(out, LEVEL_VERSION);
+	writeU32(out, columns);
+	writeU32(out, rows);
+	out.write(reinterpret_cast<const char*>(tiles.data()), tiles.size());
+	return (bool)out;
+}
+
+bool compileLevel(const char* textFile, const char* levelFile) {
+	MappedFile text;
+	std::vector<unsigned char> tiles;
+	unsigned int columns, rows;
+	if (!text.open(textFile)) {
+		std::cout << "ERROR::LEVEL: Failed to read " << textFile << std::endl;
+		return false;
+	}
+	if (!parseLevelText(reinterpret_cast<const char*>(text.data()), text.size(), tiles, columns, rows)) {
+		std::cout << "ERROR::LEVEL: No tiles in " << textFile << std::endl;
+		return false;
+	}
+	return writeLevel(levelFile, tiles, columns, rows);
+}
@@ -0,0 +1,45 @@
+#ifndef LEVEL_FILE_H
+#define LEVEL_FILE_H
+#include <cstddef>
+#include <vector>
+
+//compiled levels, so loading a level is an mmap and a pass over a flat tile array
+//instead of text parsing. The level/*.txt files stay the source format and get
+//converted with BreakoutHeadless --compile-level; GameLevel::load takes either.
+//
+//.lvl layout (little endian):
+//  char[4] "BLVL", uint32 version, uint32 columns, uint32 rows
+//  columns * rows uint8 tile codes, top row first
+
+const size_t LEVEL_HEADER_SIZE{ 16 };
+
+//read-only view of a whole file, unmapped when it goes out of scope
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const char* file);
+	void close();
+	const unsigned char* data() const { return bytes; }
+	size_t size() const { return length; }
+private:
+	const unsigned char* bytes;
+	size_t length;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+};
+
+//checks the header of a compiled level and returns its dimensions; false if data isn't one
+bool readLevelHeader(const unsigned char* data, size_t size, unsigned int& columns, unsigned int& rows);
+//parses the text format into a flat tile array; short rows are padded with empty tiles
+bool parseLevelText(const char* text, size_t size, std::vector<unsigned char>& tiles, unsigned int& columns, unsigned int& rows);
+bool writeLevel(const char* file, const std::vector<unsigned char>& tiles, unsigned int columns, unsigned int rows);
+//text level -> compiled level
+bool compileLevel(const char* textFile, const char* levelFile);
+
+#endif
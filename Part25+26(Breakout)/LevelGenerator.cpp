@@ -0,0 +1,60 @@
+#include "LevelGenerator.h"
+
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+//columns per row for 2:1 bricks in an 800x300 area
+const double LEVEL_ASPECT{ (800.0 / 300.0) / 2.0 };
+
+const char* LEVEL_PATTERN_NAMES[LEVEL_PATTERNS]{ "full", "checker", "random", "pyramid" };
+
+const char* levelPatternName(LevelPattern pattern) {
+	return pattern < LEVEL_PATTERNS ? LEVEL_PATTERN_NAMES[pattern] : "unknown";
+}
+
+bool parseLevelPattern(const std::string& name, LevelPattern& pattern) {
+	for (int p{ 0 }; p < LEVEL_PATTERNS; ++p) {
+		if (name == LEVEL_PATTERN_NAMES[p]) {
+			pattern = static_cast<LevelPattern>(p);
+			return true;
+		}
+	}
+	return false;
+}
+
+void generateLevel(const LevelSpec& spec, std::vector<unsigned char>& tiles, unsigned int& columns, unsigned int& rows) {
+	//how many tiles it takes to fit the bricks, given the fraction the pattern fills
+	double density = spec.pattern == PATTERN_FULL ? 1.0 : 0.5;
+	double area = std::max(1.0, spec.bricks / density);
+	columns = std::max(1u, static_cast<unsigned int>(std::ceil(std::sqrt(area * LEVEL_ASPECT))));
+	rows = std::max(1u, static_cast<unsigned int>(std::ceil(area / columns)));
+	tiles.assign(columns * rows, 0);
+
+	std::mt19937 rng(spec.seed);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	std::uniform_int_distribution<int> color(2, 5);
+	unsigned int placed = 0;
+	for (unsigned int y{ 0 }; y < rows; ++y) {
+		for (unsigned int x{ 0 }; x < columns; ++x) {
+			bool brick = false;
+			switch (spec.pattern) {
+			case PATTERN_FULL: brick = placed < spec.bricks; break;
+			case PATTERN_CHECKER: brick = (x + y) % 2 == 0; break;
+			case PATTERN_RANDOM: brick = unit(rng) < 0.5f; break;
+			case PATTERN_PYRAMID: {
+				//row y covers the middle (y + 1) / rows of the width; that's half the tiles overall
+				float half = 0.5f * columns * (y + 1) / rows;
+				float offset = std::abs(x + 0.5f - columns * 0.5f);
+				brick = offset < half;
+				break;
+			}
+			default: break;
+			}
+			if (brick) {
+				tiles[y * columns + x] = unit(rng) < spec.solidRatio ? 1 : static_cast<unsigned char>(color(rng));
+				placed++;
+			}
+		}
+	}
+}
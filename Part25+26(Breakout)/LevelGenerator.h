@@ -0,0 +1,32 @@
+#ifndef LEVEL_GENERATOR_H
+#define LEVEL_GENERATOR_H
+#include <string>
+#include <vector>
+
+//seeded stress levels far bigger than the shipped ones, as tile codes for GameLevel::init
+//or writeLevel. The grid is sized so the bricks keep roughly the shipped levels' 2:1
+//shape in the usual 800x300 level area
+
+enum LevelPattern {
+	PATTERN_FULL,    //every tile, exactly the requested count
+	PATTERN_CHECKER, //every other tile
+	PATTERN_RANDOM,  //each tile a coin flip
+	PATTERN_PYRAMID, //rows widening towards the bottom
+	LEVEL_PATTERNS
+};
+
+struct LevelSpec {
+	unsigned int bricks;   //roughly; only PATTERN_FULL is exact
+	float solidRatio;      //fraction of bricks that are solid, 0-1
+	LevelPattern pattern;
+	unsigned int seed;
+};
+
+//fills tiles and sets columns/rows
+void generateLevel(const LevelSpec& spec, std::vector<unsigned char>& tiles, unsigned int& columns, unsigned int& rows);
+
+const char* levelPatternName(LevelPattern pattern);
+//by name as above; false for an unknown one
+bool parseLevelPattern(const std::string& name, LevelPattern& pattern);
+
+#endif
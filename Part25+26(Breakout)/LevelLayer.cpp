@@ -0,0 +1,102 @@
+#include "LevelLayer.h"
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+//past this many areas in one refresh it's cheaper to draw everything once
+const unsigned int MAX_DIRTY_REGIONS{ 64 };
+
+LevelLayer::LevelLayer(unsigned int width, unsigned int height, glm::vec2 sceneSize)
+	: layerWidth(width), layerHeight(height), sceneSize(sceneSize), FBO(0), colorTexture(0), full(true)
+{
+	createTarget();
+}
+
+LevelLayer::~LevelLayer() {
+	deleteTarget();
+}
+
+void LevelLayer::createTarget() {
+	glGenFramebuffers(1, &FBO);
+	glGenTextures(1, &colorTexture);
+	//copied pixel for pixel, so no filtering and no mipmaps
+	glBindTexture(GL_TEXTURE_2D, colorTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, layerWidth, layerHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::LEVELLAYER: Failed to initialize FBO\n";
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void LevelLayer::deleteTarget() {
+	glDeleteFramebuffers(1, &FBO);
+	glDeleteTextures(1, &colorTexture);
+}
+
+void LevelLayer::resize(unsigned int width, unsigned int height) {
+	if (width == layerWidth && height == layerHeight) {
+		return;
+	}
+	layerWidth = width;
+	layerHeight = height;
+	deleteTarget();
+	createTarget();
+	invalidate();
+}
+
+void LevelLayer::invalidate() {
+	full = true;
+	regions.clear();
+}
+
+void LevelLayer::invalidate(glm::vec2 min, glm::vec2 max) {
+	if (full) {
+		return;
+	}
+	if (regions.size() == MAX_DIRTY_REGIONS) {
+		invalidate();
+		return;
+	}
+	regions.push_back(glm::vec4(min.x, min.y, max.x, max.y));
+}
+
+glm::vec4 LevelLayer::beginRegion(glm::vec2 min, glm::vec2 max) {
+	//scene units to whole pixels, rounding outwards so edges that land between pixels
+	//are drawn again too
+	glm::vec2 scale = glm::vec2(layerWidth, layerHeight) / sceneSize;
+	int x0 = std::max(0, static_cast<int>(std::floor(min.x * scale.x)));
+	int y0 = std::max(0, static_cast<int>(std::floor(min.y * scale.y)));
+	int x1 = std::min(static_cast<int>(layerWidth), static_cast<int>(std::ceil(max.x * scale.x)));
+	int y1 = std::min(static_cast<int>(layerHeight), static_cast<int>(std::ceil(max.y * scale.y)));
+
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glViewport(0, 0, layerWidth, layerHeight);
+	glEnable(GL_SCISSOR_TEST);
+	//the scene is top-down, GL's rows run bottom-up
+	glScissor(x0, layerHeight - y1, std::max(0, x1 - x0), std::max(0, y1 - y0));
+	glClearColor(0.f, 0.f, 0.f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	//alpha stays at 1 from the clear; blended sprites would otherwise leave it below 1 and
+	//the scene would show through when the layer is copied with blending on
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);
+	return glm::vec4(x0 / scale.x, y0 / scale.y, x1 / scale.x, y1 / scale.y);
+}
+
+void LevelLayer::end() {
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDisable(GL_SCISSOR_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+AtlasSprite LevelLayer::sprite() const {
+	return AtlasSprite{ colorTexture, glm::vec4(0.f, 1.f, 1.f, 0.f), glm::ivec2(layerWidth, layerHeight) };
+}
@@ -0,0 +1,73 @@
+#ifndef LEVEL_LAYER_H
+#define LEVEL_LAYER_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Texture.h"
+
+//the background and the bricks only change when a brick goes, so they're drawn once into
+//this offscreen layer and each frame just copies it. Anything that changes marks its area
+//dirty and refresh() draws only those areas again, scissored to them, so a frame's cost
+//doesn't depend on how many bricks the level has
+class LevelLayer {
+public:
+	//width x height pixels showing a scene of sceneSize units, like the window does
+	LevelLayer(unsigned int width, unsigned int height, glm::vec2 sceneSize);
+	~LevelLayer();
+	LevelLayer(const LevelLayer&) = delete;
+	LevelLayer& operator=(const LevelLayer&) = delete;
+
+	//the framebuffer size changed; the layer is recreated and drawn again from scratch
+	void resize(unsigned int width, unsigned int height);
+
+	//everything is drawn again on the next refresh()
+	void invalidate();
+	//just [min, max], in scene units
+	void invalidate(glm::vec2 min, glm::vec2 max);
+	bool dirty() const { return full || !regions.empty(); }
+
+	//calls draw(min, max) once for the whole scene or once per dirty area, with the layer
+	//bound and everything outside the area masked off; draw submits whatever overlaps the
+	//area and flushes before returning. Returns how many areas were drawn
+	template<typename F>
+	unsigned int refresh(F draw);
+
+	//the layer as a sprite covering the scene, flipped since GL's rows run bottom-up
+	AtlasSprite sprite() const;
+private:
+	unsigned int layerWidth, layerHeight;
+	glm::vec2 sceneSize;
+	unsigned int FBO, colorTexture;
+
+	bool full;
+	std::vector<glm::vec4> regions; //min.x, min.y, max.x, max.y
+
+	void createTarget();
+	void deleteTarget();
+	//binds the layer with the scissor on [min, max], widened to whole pixels; returns the
+	//widened area so draw() picks up everything the scissor lets through
+	glm::vec4 beginRegion(glm::vec2 min, glm::vec2 max);
+	void end();
+};
+
+template<typename F>
+unsigned int LevelLayer::refresh(F draw) {
+	if (full) {
+		regions.clear();
+		regions.push_back(glm::vec4(0.f, 0.f, sceneSize.x, sceneSize.y));
+		full = false;
+	}
+	unsigned int drawn = static_cast<unsigned int>(regions.size());
+	for (const glm::vec4& region : regions) {
+		glm::vec4 area = beginRegion(glm::vec2(region.x, region.y), glm::vec2(region.z, region.w));
+		draw(glm::vec2(area.x, area.y), glm::vec2(area.z, area.w));
+	}
+	if (drawn) {
+		end();
+	}
+	regions.clear();
+	return drawn;
+}
+
+#endif
@@ -0,0 +1,77 @@
+#include "ParticleRenderer.h"
+
+#include <algorithm>
+
+//X, Y, Life, Size and Color each get capacity 32-bit slots, in that order
+const unsigned int PARTICLE_INSTANCE_FIELDS{ 5 };
+
+ParticleRenderer::ParticleRenderer(Shader s, unsigned int capacity)
+	: shader(s), capacity(capacity)
+{
+	float vertex[] = {
+		0.f, 0.f, 0.f, 0.f,
+		0.f, 1.f, 0.f, 1.f,
+		1.f, 1.f, 1.f, 1.f,
+
+		0.f, 0.f, 0.f, 0.f,
+		1.f, 0.f, 1.f, 0.f,
+		1.f, 1.f, 1.f, 1.f,
+	};
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &quadVBO);
+	glGenBuffers(1, &instanceVBO);
+	glBindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertex), vertex, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+	//one attribute per slice, advanced once per particle
+	size_t slice = capacity * sizeof(float);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, slice * PARTICLE_INSTANCE_FIELDS, NULL, GL_STREAM_DRAW);
+	for (unsigned int f{ 0 }; f < 4; ++f) {
+		glEnableVertexAttribArray(1 + f);
+		glVertexAttribPointer(1 + f, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)(f * slice));
+		glVertexAttribDivisor(1 + f, 1);
+	}
+	glEnableVertexAttribArray(5);
+	glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(unsigned int), (void*)(4 * slice));
+	glVertexAttribDivisor(5, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+ParticleRenderer::~ParticleRenderer() {
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &quadVBO);
+	glDeleteBuffers(1, &instanceVBO);
+}
+
+void ParticleRenderer::draw(const ParticleSystem& particles) {
+	unsigned int count = std::min(particles.size(), capacity);
+	if (count == 0) {
+		return;
+	}
+	//orphan like the sprite batches, then only the live part of each slice goes up
+	size_t slice = capacity * sizeof(float);
+	size_t used = count * sizeof(float);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, slice * PARTICLE_INSTANCE_FIELDS, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0 * slice, used, particles.X);
+	glBufferSubData(GL_ARRAY_BUFFER, 1 * slice, used, particles.Y);
+	glBufferSubData(GL_ARRAY_BUFFER, 2 * slice, used, particles.Life);
+	glBufferSubData(GL_ARRAY_BUFFER, 3 * slice, used, particles.Size);
+	glBufferSubData(GL_ARRAY_BUFFER, 4 * slice, used, particles.Color);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//additive: particles only ever brighten what's under them, so draw order doesn't matter
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	shader.Use();
+	glBindVertexArray(VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(count));
+	glBindVertexArray(0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
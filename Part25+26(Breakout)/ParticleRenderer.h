@@ -0,0 +1,24 @@
+#ifndef PARTICLE_RENDERER_H
+#define PARTICLE_RENDERER_H
+
+#include "Shader.h"
+#include "ParticleSystem.h"
+
+//draws a whole ParticleSystem with one instanced, additively blended call. The pool's
+//arrays are uploaded as they are, each into its own slice of one buffer, so nothing is
+//interleaved on the CPU
+class ParticleRenderer {
+public:
+	//capacity has to match the ParticleSystem it draws
+	ParticleRenderer(Shader s, unsigned int capacity);
+	~ParticleRenderer();
+
+	void draw(const ParticleSystem& particles);
+private:
+	Shader shader;
+	unsigned int capacity;
+	unsigned int VAO;
+	unsigned int quadVBO, instanceVBO;
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "ParticleSystem.h"
+
+#include <cmath>
+#include <algorithm>
+
+#ifdef BREAKOUT_SSE
+#include <emmintrin.h>
+#endif
+
+//float arrays carved out of storage, in this order
+const unsigned int PARTICLE_FLOAT_FIELDS{ 7 };
+
+ParticleSystem::ParticleSystem(unsigned int capacity)
+	: Gravity(0.f), Drag(0.f), count(0), maxCount(capacity), random(2463534242u)
+{
+	unsigned int stride = (capacity + 3) & ~3u;
+	storage.assign(stride * PARTICLE_FLOAT_FIELDS, 0.f);
+	//colors are integers, so they can't share the float block without aliasing it
+	colors.assign(stride, 0u);
+	float* fields[PARTICLE_FLOAT_FIELDS];
+	for (unsigned int f{ 0 }; f < PARTICLE_FLOAT_FIELDS; ++f) {
+		fields[f] = storage.data() + f * stride;
+	}
+	X = fields[0];
+	Y = fields[1];
+	VelX = fields[2];
+	VelY = fields[3];
+	Life = fields[4];
+	Fade = fields[5];
+	Size = fields[6];
+	Color = colors.data();
+}
+
+float ParticleSystem::nextRandom() {
+	random ^= random << 13;
+	random ^= random >> 17;
+	random ^= random << 5;
+	return (random >> 8) * (1.f / 16777216.f);
+}
+
+bool ParticleSystem::spawn(glm::vec2 position, glm::vec2 velocity, float lifetime, float size, glm::vec4 color) {
+	if (count == maxCount) {
+		return false;
+	}
+	glm::vec4 c = glm::clamp(color, 0.f, 1.f) * 255.f + 0.5f;
+	X[count] = position.x;
+	Y[count] = position.y;
+	VelX[count] = velocity.x;
+	VelY[count] = velocity.y;
+	Life[count] = 1.f;
+	Fade[count] = 1.f / std::max(lifetime, 0.001f);
+	Size[count] = size;
+	Color[count] = unsigned(c.x) | unsigned(c.y) << 8 | unsigned(c.z) << 16 | unsigned(c.w) << 24;
+	count++;
+	return true;
+}
+
+void ParticleSystem::emit(const ParticleEmitter& emitter, glm::vec2 min, glm::vec2 max, unsigned int n, glm::vec2 baseVelocity) {
+	float heading = std::atan2(emitter.Direction.y, emitter.Direction.x);
+	for (unsigned int i{ 0 }; i < n; ++i) {
+		float u = nextRandom();
+		float v = nextRandom();
+		glm::vec2 position = min + (max - min) * glm::vec2(u, v);
+		float angle = heading + (nextRandom() * 2.f - 1.f) * emitter.Spread;
+		float speed = emitter.Speed + (nextRandom() * 2.f - 1.f) * emitter.SpeedJitter;
+		float lifetime = emitter.Lifetime + (nextRandom() * 2.f - 1.f) * emitter.LifetimeJitter;
+		glm::vec2 velocity = baseVelocity + glm::vec2(std::cos(angle), std::sin(angle)) * speed;
+		if (!spawn(position, velocity, lifetime, emitter.Size, emitter.Color)) {
+			return;
+		}
+	}
+}
+
+void ParticleSystem::removeDead() {
+	for (unsigned int i{ 0 }; i < count; ) {
+		if (Life[i] > 0.f) {
+			++i;
+		}
+		else {
+			removeAt(i);
+		}
+	}
+}
+
+void ParticleSystem::removeAt(unsigned int i) {
+	count--;
+	X[i] = X[count];
+	Y[i] = Y[count];
+	VelX[i] = VelX[count];
+	VelY[i] = VelY[count];
+	Life[i] = Life[count];
+	Fade[i] = Fade[count];
+	Size[i] = Size[count];
+	Color[i] = Color[count];
+}
+
+void ParticleSystem::updateScalar(float dt) {
+	float damping = std::max(0.f, 1.f - Drag * dt);
+	float fall = Gravity * dt;
+	for (unsigned int i{ 0 }; i < count; ++i) {
+		VelX[i] = VelX[i] * damping;
+		VelY[i] = VelY[i] * damping + fall;
+		X[i] = X[i] + VelX[i] * dt;
+		Y[i] = Y[i] + VelY[i] * dt;
+		Life[i] = Life[i] - Fade[i] * dt;
+	}
+	removeDead();
+}
+
+#ifdef BREAKOUT_SSE
+void ParticleSystem::updateSSE(float dt) {
+	float damping = std::max(0.f, 1.f - Drag * dt);
+	__m128 damp = _mm_set1_ps(damping);
+	__m128 fall = _mm_set1_ps(Gravity * dt);
+	__m128 step = _mm_set1_ps(dt);
+	//the arrays are padded to a multiple of 4, so the last group can run past count
+	for (unsigned int i{ 0 }; i < count; i += 4) {
+		__m128 vx = _mm_mul_ps(_mm_loadu_ps(VelX + i), damp);
+		__m128 vy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(VelY + i), damp), fall);
+		_mm_storeu_ps(VelX + i, vx);
+		_mm_storeu_ps(VelY + i, vy);
+		_mm_storeu_ps(X + i, _mm_add_ps(_mm_loadu_ps(X + i), _mm_mul_ps(vx, step)));
+		_mm_storeu_ps(Y + i, _mm_add_ps(_mm_loadu_ps(Y + i), _mm_mul_ps(vy, step)));
+		_mm_storeu_ps(Life + i, _mm_sub_ps(_mm_loadu_ps(Life + i), _mm_mul_ps(_mm_loadu_ps(Fade + i), step)));
+	}
+
+	//same removal as removeDead(), but skipping four live particles at a time; only a
+	//few die each frame, so nearly every group is skipped
+	__m128 zero = _mm_setzero_ps();
+	for (unsigned int i{ 0 }; i < count; ) {
+		if (i + 4 <= count && _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(Life + i), zero)) == 0) {
+			i += 4;
+		}
+		else if (Life[i] > 0.f) {
+			++i;
+		}
+		else {
+			removeAt(i);
+		}
+	}
+}
+#endif
+
+void ParticleSystem::update(float dt) {
+#ifdef BREAKOUT_SSE
+	updateSSE(dt);
+#else
+	updateScalar(dt);
+#endif
+}
@@ -0,0 +1,76 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Simd.h"
+
+//what a ParticleSystem spawns: particles start at a random point in the emit area and fly
+//off at Speed (+-SpeedJitter) in a random direction within Spread radians of Direction
+struct ParticleEmitter {
+	glm::vec2 Direction;
+	float Spread;
+	float Speed, SpeedJitter;
+	float Lifetime, LifetimeJitter; //seconds
+	float Size;
+	glm::vec4 Color;
+	//particles per second for due(); the fraction left over carries into the next call
+	float Rate;
+	float carry;
+
+	//how many particles a continuous emitter owes for the last dt seconds
+	unsigned int due(float dt) {
+		carry += Rate * dt;
+		unsigned int count = static_cast<unsigned int>(carry);
+		carry -= count;
+		return count;
+	}
+};
+
+//purely visual particles, not part of the simulation. Every particle lives in one
+//fixed-capacity pool of parallel arrays allocated up front: spawning past capacity drops
+//the new particles, and dead ones are swapped out for the last live one, so the live
+//particles are always [0, size()). Life runs from 1 down to 0 and doubles as the alpha
+class ParticleSystem {
+public:
+	//read by the renderer; padded to a multiple of 4 so the SSE loop needs no tail
+	float *X, *Y, *VelX, *VelY, *Life, *Fade, *Size;
+	unsigned int *Color; //RGBA8, red in the lowest byte
+
+	float Gravity; //pixels/s^2, down is +y
+	float Drag;    //fraction of velocity lost per second
+
+	explicit ParticleSystem(unsigned int capacity);
+	ParticleSystem(const ParticleSystem&) = delete;
+	ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+	unsigned int size() const { return count; }
+	unsigned int capacity() const { return maxCount; }
+	void clear() { count = 0; }
+
+	//n particles anywhere in [min, max], with baseVelocity added to each
+	void emit(const ParticleEmitter& emitter, glm::vec2 min, glm::vec2 max, unsigned int n, glm::vec2 baseVelocity = glm::vec2(0.f));
+	//false when the pool is full
+	bool spawn(glm::vec2 position, glm::vec2 velocity, float lifetime, float size, glm::vec4 color);
+
+	//moves and fades everything by dt, then drops what has faded out
+	void updateScalar(float dt);
+#ifdef BREAKOUT_SSE
+	void updateSSE(float dt);
+#endif
+	//the fastest of the above this build has
+	void update(float dt);
+private:
+	std::vector<float> storage;
+	std::vector<unsigned int> colors;
+	unsigned int count, maxCount;
+	unsigned int random; //xorshift state for emission jitter
+
+	//uniform in [0, 1)
+	float nextRandom();
+	void removeDead();
+	//moves the last particle into slot i
+	void removeAt(unsigned int i);
+};
+
+#endif
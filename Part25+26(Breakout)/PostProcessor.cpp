@@ -0,0 +1,135 @@
+#include "PostProcessor.h"
+
+#include <iostream>
+
+PostProcessor::PostProcessor(Shader s, unsigned int width, unsigned int height, unsigned int samples)
+	: Shake(0.f), Confuse(false), Chaos(false), Vignette(0.f),
+	shader(s), targetWidth(width), targetHeight(height), samples(samples),
+	MSFBO(0), colorTexture(0), depthBuffer(0), queryFrame(0), timedNanoseconds(0.0), timedPasses(0)
+{
+	samplesUniform = shader.Uniform("samples");
+	shakeUniform = shader.Uniform("shake");
+	timeUniform = shader.Uniform("time");
+	confuseUniform = shader.Uniform("confuse");
+	chaosUniform = shader.Uniform("chaos");
+	vignetteUniform = shader.Uniform("vignette");
+	shader.SetShadowing(true);
+	shader.Use().SetInteger("scene", 0);
+
+	//the full-screen triangle comes from gl_VertexID, but core profile still wants a VAO bound
+	glGenVertexArrays(1, &emptyVAO);
+	glGenQueries(QUERY_FRAMES, queries);
+	for (unsigned int i{ 0 }; i < QUERY_FRAMES; ++i) {
+		queryPending[i] = false;
+	}
+	createTargets();
+}
+
+PostProcessor::~PostProcessor() {
+	deleteTargets();
+	glDeleteVertexArrays(1, &emptyVAO);
+	glDeleteQueries(QUERY_FRAMES, queries);
+}
+
+void PostProcessor::createTargets() {
+	glGenFramebuffers(1, &MSFBO);
+	glGenTextures(1, &colorTexture);
+	glGenRenderbuffers(1, &depthBuffer);
+
+	//a multisample texture rather than a renderbuffer so the composite shader can read the
+	//samples itself and there's no separate resolve blit
+	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, colorTexture);
+	glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, GL_RGBA8, targetWidth, targetHeight, GL_TRUE);
+	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8, targetWidth, targetHeight);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, MSFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO\n";
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PostProcessor::deleteTargets() {
+	glDeleteFramebuffers(1, &MSFBO);
+	glDeleteTextures(1, &colorTexture);
+	glDeleteRenderbuffers(1, &depthBuffer);
+}
+
+void PostProcessor::resize(unsigned int width, unsigned int height) {
+	if (width == targetWidth && height == targetHeight) {
+		return;
+	}
+	targetWidth = width;
+	targetHeight = height;
+	deleteTargets();
+	createTargets();
+}
+
+void PostProcessor::begin() {
+	glBindFramebuffer(GL_FRAMEBUFFER, MSFBO);
+	glViewport(0, 0, targetWidth, targetHeight);
+	glClearColor(0.f, 0.f, 0.f, 1.f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void PostProcessor::end() {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PostProcessor::collectQuery(unsigned int slot) {
+	if (!queryPending[slot]) {
+		return;
+	}
+	GLuint64 elapsed = 0;
+	glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &elapsed);
+	timedNanoseconds += static_cast<double>(elapsed);
+	timedPasses++;
+	queryPending[slot] = false;
+}
+
+void PostProcessor::collectTimings() {
+	for (unsigned int i{ 0 }; i < QUERY_FRAMES; ++i) {
+		collectQuery(i);
+	}
+}
+
+void PostProcessor::resetTimings() {
+	collectTimings();
+	timedNanoseconds = 0.0;
+	timedPasses = 0;
+}
+
+void PostProcessor::composite(float time, unsigned int framebuffer) {
+	//the query in this slot was issued QUERY_FRAMES passes ago and is long done by now
+	unsigned int slot = queryFrame++ % QUERY_FRAMES;
+	collectQuery(slot);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, targetWidth, targetHeight);
+	glBeginQuery(GL_TIME_ELAPSED, queries[slot]);
+
+	shader.Use();
+	shader.SetInteger(samplesUniform, samples);
+	shader.SetFloat(shakeUniform, Shake);
+	shader.SetFloat(timeUniform, time);
+	shader.SetInteger(confuseUniform, Confuse);
+	shader.SetInteger(chaosUniform, Chaos);
+	shader.SetFloat(vignetteUniform, Vignette);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, colorTexture);
+	//blending would mix the composite with whatever the target held
+	glDisable(GL_BLEND);
+	glBindVertexArray(emptyVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glEnable(GL_BLEND);
+	glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+
+	glEndQuery(GL_TIME_ELAPSED);
+	queryPending[slot] = true;
+}
@@ -0,0 +1,60 @@
+#ifndef POST_PROCESSOR_H
+#define POST_PROCESSOR_H
+
+#include "Shader.h"
+
+//the scene is drawn into a multisampled offscreen target between begin() and end(), then
+//composite() resolves the samples and applies every effect in one full-screen pass. The
+//effects are just uniforms, so turning more of them on never adds a pass
+class PostProcessor {
+public:
+	//effect state, set by the game before composite()
+	float Shake;    //screen shake strength in pixels, 0 is off
+	bool Confuse;   //inverted colors
+	bool Chaos;     //edge detection
+	float Vignette; //how far the corners darken, 0-1
+
+	PostProcessor(Shader s, unsigned int width, unsigned int height, unsigned int samples = 4);
+	~PostProcessor();
+	PostProcessor(const PostProcessor&) = delete;
+	PostProcessor& operator=(const PostProcessor&) = delete;
+
+	//the framebuffer size changed; the targets are recreated at the new size
+	void resize(unsigned int width, unsigned int height);
+	unsigned int width() const { return targetWidth; }
+	unsigned int height() const { return targetHeight; }
+
+	//binds and clears the offscreen target, draw the scene after this
+	void begin();
+	//goes back to the default framebuffer
+	void end();
+	//resolves and composites into framebuffer (the window by default); time drives the shake
+	void composite(float time, unsigned int framebuffer = 0);
+
+	//GPU time of composite() from timer queries, averaged since the last resetTimings().
+	//Results are read a few frames late so the queries never stall the pipeline
+	double compositeMilliseconds() const { return timedPasses ? timedNanoseconds / timedPasses / 1e6 : 0.0; }
+	unsigned int timedFrames() const { return timedPasses; }
+	//waits for the queries still in flight and adds them in
+	void collectTimings();
+	void resetTimings();
+private:
+	Shader shader;
+	UniformHandle samplesUniform, shakeUniform, timeUniform, confuseUniform, chaosUniform, vignetteUniform;
+	unsigned int targetWidth, targetHeight, samples;
+	unsigned int MSFBO, colorTexture, depthBuffer;
+	unsigned int emptyVAO;
+
+	static const unsigned int QUERY_FRAMES{ 4 };
+	unsigned int queries[QUERY_FRAMES];
+	bool queryPending[QUERY_FRAMES];
+	unsigned int queryFrame;
+	double timedNanoseconds;
+	unsigned int timedPasses;
+
+	void createTargets();
+	void deleteTargets();
+	void collectQuery(unsigned int slot);
+};
+
+#endif
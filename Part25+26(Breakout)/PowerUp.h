@@ -0,0 +1,64 @@
+#ifndef POWER_UP_H
+#define POWER_UP_H
+#include <glm/glm.hpp>
+
+#include "game_object.h"
+#include "FixedPool.h"
+
+//power-ups drop out of destroyed bricks, fall, and take effect when they touch the
+//paddle. Multi-ball happens at once; the others run for a while and are undone when
+//they expire. Picking one up again while it's running just restarts its timer
+enum PowerUpType : unsigned int {
+	POWERUP_MULTI_BALL,
+	POWERUP_STICKY,       //balls stick to the paddle until launched again
+	POWERUP_PASS_THROUGH, //balls go straight through breakable bricks
+	POWERUP_GROW,         //wider paddle
+	POWERUP_SPEED_UP,
+	POWERUP_SLOW_DOWN,
+	POWERUP_TYPES
+};
+
+//one falling towards the paddle
+struct PowerUp {
+	PowerUpType Type;
+	GameObject Object;
+};
+
+//one running on the player
+struct ActiveEffect {
+	PowerUpType Type;
+	float Remaining; //seconds
+};
+
+//every effect type refreshes rather than stacks, so this is never short
+const unsigned int MAX_POWERUPS{ 64 };
+const unsigned int MAX_ACTIVE_EFFECTS{ POWERUP_TYPES };
+
+typedef FixedPool<PowerUp, MAX_POWERUPS> PowerUpPool;
+typedef FixedPool<ActiveEffect, MAX_ACTIVE_EFFECTS> EffectPool;
+
+//seconds, 0 for instant ones
+inline float powerUpDuration(PowerUpType type) {
+	switch (type) {
+	case POWERUP_STICKY: return 20.f;
+	case POWERUP_PASS_THROUGH: return 10.f;
+	case POWERUP_GROW: return 15.f;
+	case POWERUP_SPEED_UP: return 10.f;
+	case POWERUP_SLOW_DOWN: return 10.f;
+	default: return 0.f;
+	}
+}
+
+inline glm::vec3 powerUpColor(PowerUpType type) {
+	switch (type) {
+	case POWERUP_MULTI_BALL: return glm::vec3(0.9f, 0.9f, 0.3f);
+	case POWERUP_STICKY: return glm::vec3(1.f, 0.5f, 1.f);
+	case POWERUP_PASS_THROUGH: return glm::vec3(0.5f, 1.f, 0.5f);
+	case POWERUP_GROW: return glm::vec3(1.f, 0.6f, 0.4f);
+	case POWERUP_SPEED_UP: return glm::vec3(0.5f, 0.5f, 1.f);
+	case POWERUP_SLOW_DOWN: return glm::vec3(0.4f, 0.9f, 0.9f);
+	default: return glm::vec3(0.6f, 0.6f, 0.6f);
+	}
+}
+
+#endif
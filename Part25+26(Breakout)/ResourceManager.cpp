@@ -1,116 +1,293 @@
-/*******************************************************************
-** This code is part of Breakout.
-**
-** Breakout is free software: you can redistribute it and/or modify
-** it under the terms of the CC BY 4.0 license as published by
-** Creative Commons, either version 4 of the License, or (at your
-** option) any later version.
-******************************************************************/
-#include "resourcemanager.h"
-
-#include <iostream>
-#include <sstream>
-#include <fstream>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
-// Instantiate static variables
-std::map<std::string, Texture2D>    ResourceManager::Textures;
-std::map<std::string, Shader>       ResourceManager::Shaders;
-
-
-Shader ResourceManager::LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name)
-{
-    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-    return Shaders[name];
-}
-
-Shader ResourceManager::GetShader(std::string name)
-{
-    return Shaders[name];
-}
-
-Texture2D ResourceManager::LoadTexture(const char* file, bool alpha, std::string name)
-{
-    Textures[name] = loadTextureFromFile(file, alpha);
-    return Textures[name];
-}
-
-Texture2D& ResourceManager::GetTexture(std::string name)
-{
-    return Textures[name];
-}
-
-void ResourceManager::Clear()
-{
-    // (properly) delete all shaders	
-    for (auto iter : Shaders)
-        glDeleteProgram(iter.second.ID);
-    // (properly) delete all textures
-    for (auto iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
-}
-
-Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile)
-{
-    // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::string geometryCode;
-    try
-    {
-        // open files
-        std::ifstream vertexShaderFile(vShaderFile);
-        std::ifstream fragmentShaderFile(fShaderFile);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vertexShaderFile.rdbuf();
-        fShaderStream << fragmentShaderFile.rdbuf();
-        // close file handlers
-        vertexShaderFile.close();
-        fragmentShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-        // if geometry shader path is present, also load a geometry shader
-        if (gShaderFile != nullptr)
-        {
-            std::ifstream geometryShaderFile(gShaderFile);
-            std::stringstream gShaderStream;
-            gShaderStream << geometryShaderFile.rdbuf();
-            geometryShaderFile.close();
-            geometryCode = gShaderStream.str();
-        }
-    }
-    catch (std::exception e)
-    {
-        std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
-    }
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
-    const char* gShaderCode = geometryCode.c_str();
-    // 2. now create shader object from source code
-    Shader shader;
-    shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
-    return shader;
-}
-
-Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha)
-{
-    // create texture object
-    Texture2D texture;
-    if (alpha)
-    {
-        texture.Internal_Format = GL_RGBA;
-        texture.Image_Format = GL_RGBA;
-    }
-    // load image
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
-    // now generate texture
-    texture.Generate(width, height, data);
-    // and finally free image data
-    stbi_image_free(data);
-    return texture;
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "resourcemanager.h"
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <utility>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+
+#include "stb_image.h"
+#include "ThreadPool.h"
+
+// Instantiate static variables
+std::vector<Texture2D>              ResourceManager::Textures;
+std::vector<Shader>                 ResourceManager::Shaders;
+std::vector<AtlasSprite>            ResourceManager::Sprites;
+std::map<std::string, unsigned int> ResourceManager::textureNames;
+std::map<std::string, unsigned int> ResourceManager::shaderNames;
+std::map<std::string, unsigned int> ResourceManager::spriteNames;
+
+
+ShaderHandle ResourceManager::LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, const std::string& name)
+{
+    ShaderHandle handle = FindShader(name);
+    Shaders[handle.Index] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
+    return handle;
+}
+
+TextureHandle ResourceManager::LoadTexture(const char* file, bool alpha, const std::string& name)
+{
+    TextureHandle handle = FindTexture(name);
+    Textures[handle.Index] = loadTextureFromFile(file, alpha);
+    return handle;
+}
+
+std::vector<TextureHandle> ResourceManager::LoadTextures(const std::vector<TextureRequest>& requests, ThreadPool* pool)
+{
+    std::vector<TextureHandle> handles;
+    for (const TextureRequest& request : requests)
+        handles.push_back(FindTexture(request.Name));
+    // the serial path decodes exactly like the pooled one, so the two are comparable
+    if (!pool)
+    {
+        for (size_t i = 0; i < requests.size(); ++i)
+            Textures[handles[i].Index] = loadTextureFromFile(requests[i].File.c_str(), requests[i].Alpha);
+        return handles;
+    }
+
+    // decoded images come back through here, in the order they finish
+    struct Decoded
+    {
+        size_t Request;
+        int Width, Height;
+        unsigned char* Data;
+    };
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<Decoded> done;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        pool->submit([&, i]()
+        {
+            Decoded image{ i, 0, 0, nullptr };
+            image.Data = decodeImage(requests[i].File.c_str(), requests[i].Alpha, image.Width, image.Height);
+            std::lock_guard<std::mutex> guard(lock);
+            done.push_back(image);
+            ready.notify_one();
+        });
+    }
+
+    // one pixel buffer, orphaned before every upload so the driver can still be reading the
+    // previous image while the next one is copied in
+    unsigned int PBO;
+    glGenBuffers(1, &PBO);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+    // RGB rows are tightly packed, 3 bytes a pixel
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t uploaded = 0; uploaded < requests.size(); ++uploaded)
+    {
+        Decoded image;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [&]() { return !done.empty(); });
+            image = done.front();
+            done.pop_front();
+        }
+        const TextureRequest& request = requests[image.Request];
+        Texture2D texture;
+        if (request.Alpha)
+        {
+            texture.Internal_Format = GL_RGBA;
+            texture.Image_Format = GL_RGBA;
+        }
+        void* mapped = nullptr;
+        if (image.Data)
+        {
+            size_t bytes = static_cast<size_t>(image.Width) * image.Height * (request.Alpha ? 4 : 3);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+            mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            if (mapped)
+            {
+                std::memcpy(mapped, image.Data, bytes);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            }
+            else
+                std::cout << "ERROR::TEXTURE: Failed to map an upload buffer for " << request.File << ", uploading directly" << std::endl;
+        }
+        if (mapped)
+            // with a pixel buffer bound the data pointer is an offset into it
+            texture.Generate(image.Width, image.Height, nullptr);
+        else
+        {
+            // failed decode (null data) or failed map: straight from memory, buffer unbound
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            texture.Generate(image.Width, image.Height, image.Data);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+        }
+        stbi_image_free(image.Data);
+        Textures[handles[image.Request].Index] = std::move(texture);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &PBO);
+    // every task has handed its image over, but they may still be returning
+    pool->wait();
+    return handles;
+}
+
+ShaderHandle ResourceManager::FindShader(const std::string& name)
+{
+    auto found = shaderNames.find(name);
+    if (found != shaderNames.end())
+        return ShaderHandle{ found->second };
+    shaderNames[name] = Shaders.size();
+    Shaders.emplace_back();
+    return ShaderHandle{ static_cast<unsigned int>(Shaders.size() - 1) };
+}
+
+TextureHandle ResourceManager::FindTexture(const std::string& name)
+{
+    auto found = textureNames.find(name);
+    if (found != textureNames.end())
+        return TextureHandle{ found->second };
+    textureNames[name] = Textures.size();
+    Textures.emplace_back();
+    return TextureHandle{ static_cast<unsigned int>(Textures.size() - 1) };
+}
+
+SpriteHandle ResourceManager::FindSprite(const std::string& name)
+{
+    auto found = spriteNames.find(name);
+    if (found != spriteNames.end())
+        return SpriteHandle{ found->second };
+    spriteNames[name] = Sprites.size();
+    Sprites.push_back(AtlasSprite{ 0, glm::vec4(0.0f), glm::ivec2(0) });
+    return SpriteHandle{ static_cast<unsigned int>(Sprites.size() - 1) };
+}
+
+bool ResourceManager::BuildAtlas(const std::vector<AtlasSource>& sources, unsigned int padding, const char* file)
+{
+    AtlasImage atlas;
+    bool packed = packAtlas(sources, padding, atlas);
+    return writeAtlas(file, atlas) && packed;
+}
+
+bool ResourceManager::LoadAtlas(const char* file, const std::string& name)
+{
+    AtlasImage atlas;
+    if (!readAtlas(file, atlas))
+        return false;
+    Texture2D texture;
+    texture.Internal_Format = GL_RGBA;
+    texture.Image_Format = GL_RGBA;
+    texture.Wrap_S = GL_CLAMP_TO_EDGE;
+    texture.Wrap_T = GL_CLAMP_TO_EDGE;
+    texture.Filter_Min = GL_LINEAR_MIPMAP_LINEAR;
+    // each mip level halves the padding, stop before neighbouring sprites meet
+    texture.Max_Level = 0;
+    while ((2u << texture.Max_Level) <= atlas.padding)
+        texture.Max_Level++;
+    texture.Generate(atlas.width, atlas.height, atlas.pixels.data());
+    unsigned int id = texture.ID;
+    Textures[FindTexture(name).Index] = std::move(texture);
+    for (const AtlasRect& r : atlas.rects)
+    {
+        Sprites[FindSprite(r.name).Index] = AtlasSprite{
+            id,
+            glm::vec4(r.x / (float)atlas.width, r.y / (float)atlas.height, (r.x + r.w) / (float)atlas.width, (r.y + r.h) / (float)atlas.height),
+            glm::ivec2(r.w, r.h)
+        };
+    }
+    return true;
+}
+
+void ResourceManager::Clear()
+{
+    // (properly) delete all shaders	
+    for (Shader& shader : Shaders)
+        glDeleteProgram(shader.ID);
+    // textures delete themselves
+    Shaders.clear();
+    Textures.clear();
+    Sprites.clear();
+    shaderNames.clear();
+    textureNames.clear();
+    spriteNames.clear();
+}
+
+Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile)
+{
+    // 1. retrieve the vertex/fragment source code from filePath
+    std::string vertexCode;
+    std::string fragmentCode;
+    std::string geometryCode;
+    try
+    {
+        // open files
+        std::ifstream vertexShaderFile(vShaderFile);
+        std::ifstream fragmentShaderFile(fShaderFile);
+        std::stringstream vShaderStream, fShaderStream;
+        // read file's buffer contents into streams
+        vShaderStream << vertexShaderFile.rdbuf();
+        fShaderStream << fragmentShaderFile.rdbuf();
+        // close file handlers
+        vertexShaderFile.close();
+        fragmentShaderFile.close();
+        // convert stream into string
+        vertexCode = vShaderStream.str();
+        fragmentCode = fShaderStream.str();
+        // if geometry shader path is present, also load a geometry shader
+        if (gShaderFile != nullptr)
+        {
+            std::ifstream geometryShaderFile(gShaderFile);
+            std::stringstream gShaderStream;
+            gShaderStream << geometryShaderFile.rdbuf();
+            geometryShaderFile.close();
+            geometryCode = gShaderStream.str();
+        }
+    }
+    catch (std::exception e)
+    {
+        std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
+    }
+    const char* vShaderCode = vertexCode.c_str();
+    const char* fShaderCode = fragmentCode.c_str();
+    const char* gShaderCode = geometryCode.c_str();
+    // 2. now create shader object from source code
+    Shader shader;
+    shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
+    return shader;
+}
+
+unsigned char* ResourceManager::decodeImage(const char* file, bool alpha, int& width, int& height)
+{
+    // always RGBA or RGB to match the texture's format, whatever the file has
+    int channels;
+    unsigned char* data = stbi_load(file, &width, &height, &channels, alpha ? 4 : 3);
+    if (!data)
+    {
+        std::cout << "ERROR::TEXTURE: Failed to load " << file << std::endl;
+        width = height = 0;
+    }
+    return data;
+}
+
+Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha)
+{
+    // create texture object
+    Texture2D texture;
+    if (alpha)
+    {
+        texture.Internal_Format = GL_RGBA;
+        texture.Image_Format = GL_RGBA;
+    }
+    // load image
+    int width, height;
+    unsigned char* data = decodeImage(file, alpha, width, height);
+    // now generate texture; RGB rows are tightly packed, 3 bytes a pixel
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    texture.Generate(width, height, data);
+    // and finally free image data
+    stbi_image_free(data);
+    return texture;
 }
\ No newline at end of file
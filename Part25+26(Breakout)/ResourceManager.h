@@ -1,51 +1,95 @@
-/*******************************************************************
-** This code is part of Breakout.
-**
-** Breakout is free software: you can redistribute it and/or modify
-** it under the terms of the CC BY 4.0 license as published by
-** Creative Commons, either version 4 of the License, or (at your
-** option) any later version.
-******************************************************************/
-#ifndef RESOURCE_MANAGER_H
-#define RESOURCE_MANAGER_H
-
-#include <map>
-#include <string>
-
-#include <glad/glad.h>
-
-#include "texture.h"
-#include "shader.h"
-
-
-// A static singleton ResourceManager class that hosts several
-// functions to load Textures and Shaders. Each loaded texture
-// and/or shader is also stored for future reference by string
-// handles. All functions and resources are static and no 
-// public constructor is defined.
-class ResourceManager
-{
-public:
-    // resource storage
-    static std::map<std::string, Shader>    Shaders;
-    static std::map<std::string, Texture2D> Textures;
-    // loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader
-    static Shader    LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name);
-    // retrieves a stored sader
-    static Shader    GetShader(std::string name);
-    // loads (and generates) a texture from file
-    static Texture2D LoadTexture(const char* file, bool alpha, std::string name);
-    // retrieves a stored texture
-    static Texture2D& GetTexture(std::string name);
-    // properly de-allocates all loaded resources
-    static void      Clear();
-private:
-    // private constructor, that is we do not want any actual resource manager objects. Its members and functions should be publicly available (static).
-    ResourceManager() { }
-    // loads and generates a shader from file
-    static Shader    loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile = nullptr);
-    // loads a single texture from file
-    static Texture2D loadTextureFromFile(const char* file, bool alpha);
-};
-
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef RESOURCE_MANAGER_H
+#define RESOURCE_MANAGER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "texture.h"
+#include "shader.h"
+#include "TextureAtlas.h"
+
+
+// Small integer handles into the ResourceManager's storage. Names are
+// only looked up when a resource is registered or a handle is fetched;
+// hot paths keep the handle and index straight into a dense array.
+struct ShaderHandle  { unsigned int Index; };
+struct TextureHandle { unsigned int Index; };
+struct SpriteHandle  { unsigned int Index; };
+
+// One image for ResourceManager::LoadTextures.
+struct TextureRequest
+{
+    std::string File;
+    bool        Alpha;
+    std::string Name;
+};
+
+class ThreadPool;
+
+
+// A static singleton ResourceManager class that hosts several
+// functions to load Textures and Shaders. Each loaded texture
+// and/or shader is stored in a dense array and referred to by
+// a small handle; the string names are only used to hand those
+// handles out. All functions and resources are static and no 
+// public constructor is defined.
+class ResourceManager
+{
+public:
+    // resource storage
+    static std::vector<Shader>      Shaders;
+    static std::vector<Texture2D>   Textures; // the only owners of texture objects
+    static std::vector<AtlasSprite> Sprites;
+    // loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader
+    static ShaderHandle  LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, const std::string& name);
+    // loads (and generates) a texture from file
+    static TextureHandle LoadTexture(const char* file, bool alpha, const std::string& name);
+    // loads a batch of textures, returning their handles in request order. The images are
+    // decoded on pool while this (GL) thread uploads each one through a pixel buffer as soon
+    // as it's decoded, in whatever order they finish; without a pool they're decoded and
+    // uploaded one after another on this thread
+    static std::vector<TextureHandle> LoadTextures(const std::vector<TextureRequest>& requests, ThreadPool* pool);
+    // packs the given images into a single atlas file (no GL needed, can be done offline)
+    static bool          BuildAtlas(const std::vector<AtlasSource>& sources, unsigned int padding, const char* file);
+    // loads an atlas file as one mipmapped texture stored under name, and each sprite in it under its own name
+    static bool          LoadAtlas(const char* file, const std::string& name);
+    // looks up the handle registered under name; if nothing is loaded under it yet an empty slot is
+    // reserved, so handles can be fetched before the resource is loaded. Load time only.
+    static ShaderHandle  FindShader(const std::string& name);
+    static TextureHandle FindTexture(const std::string& name);
+    static SpriteHandle  FindSprite(const std::string& name);
+    // retrieves a stored resource; the reference is only good until the next resource is registered.
+    // Textures stay owned here, everything else draws through the TextureRef
+    static Shader&      GetShader(ShaderHandle handle) { return Shaders[handle.Index]; }
+    static TextureRef   GetTexture(TextureHandle handle) { return Textures[handle.Index].Ref(); }
+    static AtlasSprite& GetSprite(SpriteHandle handle) { return Sprites[handle.Index]; }
+    // properly de-allocates all loaded resources
+    static void          Clear();
+private:
+    // name -> index into the arrays above
+    static std::map<std::string, unsigned int> shaderNames;
+    static std::map<std::string, unsigned int> textureNames;
+    static std::map<std::string, unsigned int> spriteNames;
+
+    // private constructor, that is we do not want any actual resource manager objects. Its members and functions should be publicly available (static).
+    ResourceManager() { }
+    // loads and generates a shader from file
+    static Shader    loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile = nullptr);
+    // loads a single texture from file
+    static Texture2D loadTextureFromFile(const char* file, bool alpha);
+    // decodes an image as RGBA (alpha) or RGB for either load path; free with stbi_image_free
+    static unsigned char* decodeImage(const char* file, bool alpha, int& width, int& height);
+};
+
 #endif
\ No newline at end of file
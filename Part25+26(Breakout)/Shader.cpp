@@ -1,137 +1,225 @@
-/*******************************************************************
-** This code is part of Breakout.
-**
-** Breakout is free software: you can redistribute it and/or modify
-** it under the terms of the CC BY 4.0 license as published by
-** Creative Commons, either version 4 of the License, or (at your
-** option) any later version.
-******************************************************************/
-#include "shader.h"
-
-#include <iostream>
-
-Shader& Shader::Use()
-{
-    glUseProgram(this->ID);
-    return *this;
-}
-
-void Shader::Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
-{
-    unsigned int sVertex, sFragment, gShader;
-    // vertex Shader
-    sVertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(sVertex, 1, &vertexSource, NULL);
-    glCompileShader(sVertex);
-    checkCompileErrors(sVertex, "VERTEX");
-    // fragment Shader
-    sFragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(sFragment, 1, &fragmentSource, NULL);
-    glCompileShader(sFragment);
-    checkCompileErrors(sFragment, "FRAGMENT");
-    // if geometry shader source code is given, also compile geometry shader
-    if (geometrySource != nullptr)
-    {
-        gShader = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(gShader, 1, &geometrySource, NULL);
-        glCompileShader(gShader);
-        checkCompileErrors(gShader, "GEOMETRY");
-    }
-    // shader program
-    this->ID = glCreateProgram();
-    glAttachShader(this->ID, sVertex);
-    glAttachShader(this->ID, sFragment);
-    if (geometrySource != nullptr)
-        glAttachShader(this->ID, gShader);
-    glLinkProgram(this->ID);
-    checkCompileErrors(this->ID, "PROGRAM");
-    // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(sVertex);
-    glDeleteShader(sFragment);
-    if (geometrySource != nullptr)
-        glDeleteShader(gShader);
-}
-
-void Shader::SetFloat(const char* name, float value, bool useShader)
-{
-    if (useShader)
-        this->Use();
-    glUniform1f(glGetUniformLocation(this->ID, name), value);
-}
-void Shader::SetInteger(const char* name, int value, bool useShader)
-{
-    if (useShader)
-        this->Use();
-    glUniform1i(glGetUniformLocation(this->ID, name), value);
-}
-void Shader::SetVector2f(const char* name, float x, float y, bool useShader)
-{
-    if (useShader)
-        this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), x, y);
-}
-void Shader::SetVector2f(const char* name, const glm::vec2& value, bool useShader)
-{
-    if (useShader)
-        this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
-}
-void Shader::SetVector3f(const char* name, float x, float y, float z, bool useShader)
-{
-    if (useShader)
-        this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
-}
-void Shader::SetVector3f(const char* name, const glm::vec3& value, bool useShader)
-{
-    if (useShader)
-        this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
-}
-void Shader::SetVector4f(const char* name, float x, float y, float z, float w, bool useShader)
-{
-    if (useShader)
-        this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
-}
-void Shader::SetVector4f(const char* name, const glm::vec4& value, bool useShader)
-{
-    if (useShader)
-        this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
-}
-void Shader::SetMatrix4(const char* name, const glm::mat4& matrix, bool useShader)
-{
-    if (useShader)
-        this->Use();
-    glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
-}
-
-
-void Shader::checkCompileErrors(unsigned int object, std::string type)
-{
-    int success;
-    char infoLog[1024];
-    if (type != "PROGRAM")
-    {
-        glGetShaderiv(object, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(object, 1024, NULL, infoLog);
-            std::cout << "| ERROR::SHADER: Compile-time error: Type: " << type << "\n"
-                << infoLog << "\n -- --------------------------------------------------- -- "
-                << std::endl;
-        }
-    }
-    else
-    {
-        glGetProgramiv(object, GL_LINK_STATUS, &success);
-        if (!success)
-        {
-            glGetProgramInfoLog(object, 1024, NULL, infoLog);
-            std::cout << "| ERROR::Shader: Link-time error: Type: " << type << "\n"
-                << infoLog << "\n -- --------------------------------------------------- -- "
-                << std::endl;
-        }
-    }
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "shader.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+Shader& Shader::Use()
+{
+    glUseProgram(this->ID);
+    return *this;
+}
+
+void Shader::Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
+{
+    unsigned int sVertex, sFragment, gShader;
+    // vertex Shader
+    sVertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(sVertex, 1, &vertexSource, NULL);
+    glCompileShader(sVertex);
+    checkCompileErrors(sVertex, "VERTEX");
+    // fragment Shader
+    sFragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(sFragment, 1, &fragmentSource, NULL);
+    glCompileShader(sFragment);
+    checkCompileErrors(sFragment, "FRAGMENT");
+    // if geometry shader source code is given, also compile geometry shader
+    if (geometrySource != nullptr)
+    {
+        gShader = glCreateShader(GL_GEOMETRY_SHADER);
+        glShaderSource(gShader, 1, &geometrySource, NULL);
+        glCompileShader(gShader);
+        checkCompileErrors(gShader, "GEOMETRY");
+    }
+    // shader program
+    this->ID = glCreateProgram();
+    glAttachShader(this->ID, sVertex);
+    glAttachShader(this->ID, sFragment);
+    if (geometrySource != nullptr)
+        glAttachShader(this->ID, gShader);
+    glLinkProgram(this->ID);
+    checkCompileErrors(this->ID, "PROGRAM");
+    reflectUniforms();
+    // delete the shaders as they're linked into our program now and no longer necessary
+    glDeleteShader(sVertex);
+    glDeleteShader(sFragment);
+    if (geometrySource != nullptr)
+        glDeleteShader(gShader);
+}
+
+UniformHandle Shader::Uniform(const char* name) const
+{
+    if (this->uniforms)
+    {
+        for (const auto& entry : this->uniforms->Locations)
+            if (entry.first == name)
+                return UniformHandle{ entry.second };
+    }
+    return UniformHandle{ -1 };
+}
+
+void Shader::SetShadowing(bool enabled)
+{
+    if (!this->uniforms)
+        return;
+    this->uniforms->Shadowing = enabled;
+    this->uniforms->Valid.assign(this->uniforms->Valid.size(), false);
+}
+
+bool Shader::changed(int location, const void* data, size_t bytes)
+{
+    if (location < 0)
+        return false;
+    if (!this->uniforms || !this->uniforms->Shadowing || location >= (int)this->uniforms->Values.size())
+        return true;
+    std::vector<float>& shadow = this->uniforms->Values[location];
+    if (this->uniforms->Valid[location] && std::memcmp(shadow.data(), data, bytes) == 0)
+        return false;
+    std::memcpy(shadow.data(), data, bytes);
+    this->uniforms->Valid[location] = true;
+    return true;
+}
+
+void Shader::SetFloat(UniformHandle uniform, float value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    if (changed(uniform.Location, &value, sizeof(value)))
+        glUniform1f(uniform.Location, value);
+}
+void Shader::SetInteger(UniformHandle uniform, int value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    if (changed(uniform.Location, &value, sizeof(value)))
+        glUniform1i(uniform.Location, value);
+}
+void Shader::SetVector2f(UniformHandle uniform, const glm::vec2& value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    if (changed(uniform.Location, glm::value_ptr(value), sizeof(float) * 2))
+        glUniform2f(uniform.Location, value.x, value.y);
+}
+void Shader::SetVector3f(UniformHandle uniform, const glm::vec3& value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    if (changed(uniform.Location, glm::value_ptr(value), sizeof(float) * 3))
+        glUniform3f(uniform.Location, value.x, value.y, value.z);
+}
+void Shader::SetVector4f(UniformHandle uniform, const glm::vec4& value, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    if (changed(uniform.Location, glm::value_ptr(value), sizeof(float) * 4))
+        glUniform4f(uniform.Location, value.x, value.y, value.z, value.w);
+}
+void Shader::SetMatrix4(UniformHandle uniform, const glm::mat4& matrix, bool useShader)
+{
+    if (useShader)
+        this->Use();
+    if (changed(uniform.Location, glm::value_ptr(matrix), sizeof(float) * 16))
+        glUniformMatrix4fv(uniform.Location, 1, false, glm::value_ptr(matrix));
+}
+
+void Shader::SetFloat(const char* name, float value, bool useShader)
+{
+    this->SetFloat(this->Uniform(name), value, useShader);
+}
+void Shader::SetInteger(const char* name, int value, bool useShader)
+{
+    this->SetInteger(this->Uniform(name), value, useShader);
+}
+void Shader::SetVector2f(const char* name, float x, float y, bool useShader)
+{
+    this->SetVector2f(this->Uniform(name), glm::vec2(x, y), useShader);
+}
+void Shader::SetVector2f(const char* name, const glm::vec2& value, bool useShader)
+{
+    this->SetVector2f(this->Uniform(name), value, useShader);
+}
+void Shader::SetVector3f(const char* name, float x, float y, float z, bool useShader)
+{
+    this->SetVector3f(this->Uniform(name), glm::vec3(x, y, z), useShader);
+}
+void Shader::SetVector3f(const char* name, const glm::vec3& value, bool useShader)
+{
+    this->SetVector3f(this->Uniform(name), value, useShader);
+}
+void Shader::SetVector4f(const char* name, float x, float y, float z, float w, bool useShader)
+{
+    this->SetVector4f(this->Uniform(name), glm::vec4(x, y, z, w), useShader);
+}
+void Shader::SetVector4f(const char* name, const glm::vec4& value, bool useShader)
+{
+    this->SetVector4f(this->Uniform(name), value, useShader);
+}
+void Shader::SetMatrix4(const char* name, const glm::mat4& matrix, bool useShader)
+{
+    this->SetMatrix4(this->Uniform(name), matrix, useShader);
+}
+
+void Shader::reflectUniforms()
+{
+    this->uniforms = std::make_shared<UniformTable>();
+    int count = 0, maxLength = 0;
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> buffer(maxLength + 1);
+    int maxLocation = -1;
+    for (int i = 0; i < count; ++i)
+    {
+        int size = 0, length = 0;
+        unsigned int type = 0;
+        glGetActiveUniform(this->ID, i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), length);
+        int location = glGetUniformLocation(this->ID, name.c_str());
+        if (location < 0) // uniform block members have no location
+            continue;
+        this->uniforms->Locations.emplace_back(name, location);
+        // arrays are reported as "name[0]", make the plain name work too
+        size_t bracket = name.find('[');
+        if (bracket != std::string::npos)
+            this->uniforms->Locations.emplace_back(name.substr(0, bracket), location);
+        maxLocation = std::max(maxLocation, location + size - 1);
+    }
+    this->uniforms->Values.assign(maxLocation + 1, std::vector<float>(16));
+    this->uniforms->Valid.assign(maxLocation + 1, false);
+}
+
+void Shader::checkCompileErrors(unsigned int object, std::string type)
+{
+    int success;
+    char infoLog[1024];
+    if (type != "PROGRAM")
+    {
+        glGetShaderiv(object, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(object, 1024, NULL, infoLog);
+            std::cout << "| ERROR::SHADER: Compile-time error: Type: " << type << "\n"
+                << infoLog << "\n -- --------------------------------------------------- -- "
+                << std::endl;
+        }
+    }
+    else
+    {
+        glGetProgramiv(object, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            glGetProgramInfoLog(object, 1024, NULL, infoLog);
+            std::cout << "| ERROR::Shader: Link-time error: Type: " << type << "\n"
+                << infoLog << "\n -- --------------------------------------------------- -- "
+                << std::endl;
+        }
+    }
 }
\ No newline at end of file
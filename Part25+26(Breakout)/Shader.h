@@ -1,47 +1,84 @@
-/*******************************************************************
-** This code is part of Breakout.
-**
-** Breakout is free software: you can redistribute it and/or modify
-** it under the terms of the CC BY 4.0 license as published by
-** Creative Commons, either version 4 of the License, or (at your
-** option) any later version.
-******************************************************************/
-#ifndef SHADER_H
-#define SHADER_H
-
-#include <string>
-
-#include <glad/glad.h>
-#include <glm/glm.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-// General purpose shader object. Compiles from file, generates
-// compile/link-time error messages and hosts several utility 
-// functions for easy management.
-class Shader
-{
-public:
-    // state
-    unsigned int ID;
-    // constructor
-    Shader() { }
-    // sets the current shader as active
-    Shader& Use();
-    // compiles the shader from given source code
-    void    Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource = nullptr); // note: geometry source code is optional 
-    // utility functions
-    void    SetFloat(const char* name, float value, bool useShader = false);
-    void    SetInteger(const char* name, int value, bool useShader = false);
-    void    SetVector2f(const char* name, float x, float y, bool useShader = false);
-    void    SetVector2f(const char* name, const glm::vec2& value, bool useShader = false);
-    void    SetVector3f(const char* name, float x, float y, float z, bool useShader = false);
-    void    SetVector3f(const char* name, const glm::vec3& value, bool useShader = false);
-    void    SetVector4f(const char* name, float x, float y, float z, float w, bool useShader = false);
-    void    SetVector4f(const char* name, const glm::vec4& value, bool useShader = false);
-    void    SetMatrix4(const char* name, const glm::mat4& matrix, bool useShader = false);
-private:
-    // checks if compilation or linking failed and if so, print the error logs
-    void    checkCompileErrors(unsigned int object, std::string type);
-};
-
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// A uniform location resolved ahead of time with Shader::Uniform,
+// so the setters don't have to look the name up on every call.
+struct UniformHandle
+{
+    int Location; // -1 if the uniform isn't active in the program
+};
+
+
+// General purpose shader object. Compiles from file, generates
+// compile/link-time error messages and hosts several utility 
+// functions for easy management. After linking, the program's
+// active uniforms are reflected into a location table that is
+// shared between copies of the Shader.
+class Shader
+{
+public:
+    // state
+    unsigned int ID;
+    // constructor
+    Shader() : ID(0) { }
+    // sets the current shader as active
+    Shader& Use();
+    // compiles the shader from given source code
+    void    Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource = nullptr); // note: geometry source code is optional 
+    // looks up a uniform in the reflected table
+    UniformHandle Uniform(const char* name) const;
+    // when enabled, the last value uploaded to each uniform is remembered and setting the
+    // same value again skips the GL call. Only safe if all uniform uploads for this program
+    // go through Shader
+    void    SetShadowing(bool enabled);
+    // utility functions
+    void    SetFloat(UniformHandle uniform, float value, bool useShader = false);
+    void    SetInteger(UniformHandle uniform, int value, bool useShader = false);
+    void    SetVector2f(UniformHandle uniform, const glm::vec2& value, bool useShader = false);
+    void    SetVector3f(UniformHandle uniform, const glm::vec3& value, bool useShader = false);
+    void    SetVector4f(UniformHandle uniform, const glm::vec4& value, bool useShader = false);
+    void    SetMatrix4(UniformHandle uniform, const glm::mat4& matrix, bool useShader = false);
+    void    SetFloat(const char* name, float value, bool useShader = false);
+    void    SetInteger(const char* name, int value, bool useShader = false);
+    void    SetVector2f(const char* name, float x, float y, bool useShader = false);
+    void    SetVector2f(const char* name, const glm::vec2& value, bool useShader = false);
+    void    SetVector3f(const char* name, float x, float y, float z, bool useShader = false);
+    void    SetVector3f(const char* name, const glm::vec3& value, bool useShader = false);
+    void    SetVector4f(const char* name, float x, float y, float z, float w, bool useShader = false);
+    void    SetVector4f(const char* name, const glm::vec4& value, bool useShader = false);
+    void    SetMatrix4(const char* name, const glm::mat4& matrix, bool useShader = false);
+private:
+    struct UniformTable
+    {
+        std::vector<std::pair<std::string, int>> Locations;
+        bool Shadowing = false;
+        // last uploaded value per location, big enough for a mat4
+        std::vector<std::vector<float>> Values;
+        std::vector<bool> Valid;
+    };
+    std::shared_ptr<UniformTable> uniforms;
+    // checks if compilation or linking failed and if so, print the error logs
+    void    checkCompileErrors(unsigned int object, std::string type);
+    // fills the uniform table from the linked program
+    void    reflectUniforms();
+    // with shadowing on, returns false if the uniform already holds this value (and records it otherwise)
+    bool    changed(int location, const void* data, size_t bytes);
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,10 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+//BREAKOUT_SSE is defined when the target has SSE2; the hand-vectorized loops (sweep kernel,
+//particles) check it and fall back to their scalar versions without it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BREAKOUT_SSE 1
+#endif
+
+#endif
@@ -1,57 +1,178 @@
-#include "SpriteRenderer.h"
-
-SpriteRenderer::SpriteRenderer(Shader s) {
-	this->shader = s;
-	this->initRenderData();
-}
-SpriteRenderer::~SpriteRenderer() {
-	glDeleteVertexArrays(1, &this->quadVAO);
-}
-
-void SpriteRenderer::drawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color) {
-	this->shader.Use();
-	glm::mat4 model = glm::mat4(1.0);
-	model = glm::translate(model, glm::vec3(position, 1.0));
-
-	model = glm::translate(model, glm::vec3(0.5f * size.x, 0.5f * size.y, 0.f));
-	model = glm::rotate(model, glm::radians(rotate), glm::vec3(0.f, 0.f, 1.f));
-	model = glm::translate(model, glm::vec3(-0.5f * size.x, -0.5f * size.y, 0.f));
-
-	model = glm::scale(model, glm::vec3(size, 1.0));
-
-	glActiveTexture(GL_TEXTURE0);
-	texture.Bind();
-
-	this->shader.SetMatrix4("model", model);
-	this->shader.SetVector3f("spriteColor", color);
-
-	glBindVertexArray(this->quadVAO);
-	glDrawArrays(GL_TRIANGLES, 0, 6);
-	glBindVertexArray(0);
-}
-
-void SpriteRenderer::initRenderData() {
-	unsigned int VBO;
-	float vertex[] = {
-		0.f, 0.f, 0.f, 0.f,
-		0.f, 1.f, 0.f, 1.f,
-		1.f, 1.f, 1.f, 1.f,
-
-		0.f, 0.f, 0.f, 0.f,
-		1.f, 0.f, 1.f, 0.f,
-		1.f, 1.f, 1.f, 1.f,
-	};
-
-	glGenVertexArrays(1, &this->quadVAO);
-	glGenBuffers(1, &VBO);
-
-	glBindVertexArray(this->quadVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertex), &vertex, GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+#include "SpriteRenderer.h"
+#include <cstddef>
+
+SpriteRenderer::SpriteRenderer(Shader s, Shader batch)
+	: activeBatches(0), lastBatch(0), instanceCapacity(0)
+{
+	this->shader = s;
+	this->batchShader = batch;
+	//drawSprite sets these for every sprite, consecutive sprites often share a color
+	this->modelUniform = this->shader.Uniform("model");
+	this->colorUniform = this->shader.Uniform("spriteColor");
+	this->shader.SetShadowing(true);
+	this->initRenderData();
+	this->initBatchData();
+}
+SpriteRenderer::~SpriteRenderer() {
+	glDeleteVertexArrays(1, &this->quadVAO);
+	glDeleteVertexArrays(1, &this->batchVAO);
+	glDeleteBuffers(1, &this->quadVBO);
+	glDeleteBuffers(1, &this->instanceVBO);
+}
+
+void SpriteRenderer::drawSprite(TextureRef texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color) {
+	this->shader.Use();
+	glm::mat4 model = glm::mat4(1.0);
+	model = glm::translate(model, glm::vec3(position, 1.0));
+
+	model = glm::translate(model, glm::vec3(0.5f * size.x, 0.5f * size.y, 0.f));
+	model = glm::rotate(model, glm::radians(rotate), glm::vec3(0.f, 0.f, 1.f));
+	model = glm::translate(model, glm::vec3(-0.5f * size.x, -0.5f * size.y, 0.f));
+
+	model = glm::scale(model, glm::vec3(size, 1.0));
+
+	glActiveTexture(GL_TEXTURE0);
+	texture.Bind();
+
+	this->shader.SetMatrix4(this->modelUniform, model);
+	this->shader.SetVector3f(this->colorUniform, color);
+
+	glBindVertexArray(this->quadVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+	glBindVertexArray(0);
+}
+
+void SpriteRenderer::begin() {
+	for (unsigned int i{ 0 }; i < activeBatches; ++i) {
+		batches[i].instances.clear();
+	}
+	activeBatches = 0;
+	lastBatch = 0;
+}
+
+void SpriteRenderer::submit(TextureRef texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color) {
+	submitInstance(texture.ID, SpriteInstance{ position, size, color, rotate, glm::vec4(0.f, 0.f, 1.f, 1.f) });
+}
+
+void SpriteRenderer::submit(const AtlasSprite &sprite, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color) {
+	submitInstance(sprite.TextureID, SpriteInstance{ position, size, color, rotate, sprite.UV });
+}
+
+void SpriteRenderer::submitInstance(unsigned int texture, const SpriteInstance &instance) {
+	//sprites tend to come in runs of the same texture, so check the last batch first
+	if (lastBatch >= activeBatches || batches[lastBatch].texture != texture) {
+		lastBatch = 0;
+		while (lastBatch < activeBatches && batches[lastBatch].texture != texture) {
+			lastBatch++;
+		}
+		if (lastBatch == activeBatches) {
+			if (activeBatches == batches.size()) {
+				batches.emplace_back();
+			}
+			batches[activeBatches].texture = texture;
+			activeBatches++;
+		}
+	}
+	batches[lastBatch].instances.push_back(instance);
+}
+
+void SpriteRenderer::flush() {
+	size_t total = 0;
+	for (unsigned int i{ 0 }; i < activeBatches; ++i) {
+		total += batches[i].instances.size();
+	}
+	if (total == 0) {
+		begin();
+		return;
+	}
+
+	//orphan the buffer each flush so we never wait on last frame's draws
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	if (total > instanceCapacity) {
+		instanceCapacity = total * 2;
+	}
+	glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+	size_t offset = 0;
+	for (unsigned int i{ 0 }; i < activeBatches; ++i) {
+		std::vector<SpriteInstance>& instances = batches[i].instances;
+		glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(SpriteInstance), instances.size() * sizeof(SpriteInstance), instances.data());
+		offset += instances.size();
+	}
+
+	this->batchShader.Use();
+	glActiveTexture(GL_TEXTURE0);
+	glBindVertexArray(this->batchVAO);
+	offset = 0;
+	for (unsigned int i{ 0 }; i < activeBatches; ++i) {
+		std::vector<SpriteInstance>& instances = batches[i].instances;
+		if (instances.empty()) {
+			continue;
+		}
+		//GL 3.3 has no base instance, so point the instance attributes at this batch's range
+		size_t base = offset * sizeof(SpriteInstance);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(base + offsetof(SpriteInstance, position)));
+		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(base + offsetof(SpriteInstance, color)));
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(base + offsetof(SpriteInstance, uv)));
+
+		glBindTexture(GL_TEXTURE_2D, batches[i].texture);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(instances.size()));
+		offset += instances.size();
+	}
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	begin();
+}
+
+void SpriteRenderer::initRenderData() {
+	unsigned int VBO;
+	float vertex[] = {
+		0.f, 0.f, 0.f, 0.f,
+		0.f, 1.f, 0.f, 1.f,
+		1.f, 1.f, 1.f, 1.f,
+
+		0.f, 0.f, 0.f, 0.f,
+		1.f, 0.f, 1.f, 0.f,
+		1.f, 1.f, 1.f, 1.f,
+	};
+
+	glGenVertexArrays(1, &this->quadVAO);
+	glGenBuffers(1, &VBO);
+	this->quadVBO = VBO;
+
+	glBindVertexArray(this->quadVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertex), &vertex, GL_STATIC_DRAW);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+void SpriteRenderer::initBatchData() {
+	glGenVertexArrays(1, &this->batchVAO);
+	glGenBuffers(1, &this->instanceVBO);
+
+	glBindVertexArray(this->batchVAO);
+	//same unit quad as the single sprite path
+	glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+	//<vec2 position, vec2 size>, <vec3 color, float rotate> and the uv rect, advanced once per sprite
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, position));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, color));
+	glVertexAttribDivisor(2, 1);
+	glEnableVertexAttribArray(3);
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)offsetof(SpriteInstance, uv));
+	glVertexAttribDivisor(3, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
 }
\ No newline at end of file
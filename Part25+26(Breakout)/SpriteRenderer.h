@@ -1,22 +1,58 @@
-#ifndef SPRITE_RENDERER_H
-#define SPRITE_RENDERER_H
-
-#include "Shader.h"
-#include "Texture.h"
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-
-class SpriteRenderer {
-public:
-	SpriteRenderer(Shader s);
-	~SpriteRenderer();
-
-	void drawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.f, 10.f), float rotate = 0.f, glm::vec3 color = glm::vec3(1.0f));
-private:
-	Shader shader;
-	unsigned int quadVAO;
-
-	void initRenderData();
-};
-
-#endif
\ No newline at end of file
+#ifndef SPRITE_RENDERER_H
+#define SPRITE_RENDERER_H
+
+#include <vector>
+#include "Shader.h"
+#include "Texture.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+//per-sprite data for the batched path, the vertex shader builds the transform from it
+struct SpriteInstance {
+	glm::vec2 position;
+	glm::vec2 size;
+	glm::vec3 color;
+	float rotate;
+	glm::vec4 uv; //u0, v0, u1, v1
+};
+
+class SpriteRenderer {
+public:
+	SpriteRenderer(Shader s, Shader batch);
+	~SpriteRenderer();
+
+	void drawSprite(TextureRef texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.f, 10.f), float rotate = 0.f, glm::vec3 color = glm::vec3(1.0f));
+
+	//batched drawing: sprites submitted between begin() and flush() are grouped by texture
+	//and each group is drawn with one instanced call. Groups are drawn in the order their
+	//texture was first submitted, so flush() between layers that must not reorder
+	void begin();
+	void submit(TextureRef texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.f, 10.f), float rotate = 0.f, glm::vec3 color = glm::vec3(1.0f));
+	//sprites from the same atlas share a batch no matter which sprite they are
+	void submit(const AtlasSprite &sprite, glm::vec2 position, glm::vec2 size = glm::vec2(10.f, 10.f), float rotate = 0.f, glm::vec3 color = glm::vec3(1.0f));
+	void flush();
+private:
+	Shader shader;
+	Shader batchShader;
+	UniformHandle modelUniform, colorUniform;
+	unsigned int quadVAO;
+	unsigned int quadVBO;
+
+	struct SpriteBatch {
+		unsigned int texture;
+		std::vector<SpriteInstance> instances;
+	};
+	//batches are kept across frames so their instance vectors keep their capacity
+	std::vector<SpriteBatch> batches;
+	unsigned int activeBatches;
+	unsigned int lastBatch;
+	unsigned int batchVAO;
+	unsigned int instanceVBO;
+	size_t instanceCapacity;
+
+	void initRenderData();
+	void initBatchData();
+	void submitInstance(unsigned int texture, const SpriteInstance &instance);
+};
+
+#endif
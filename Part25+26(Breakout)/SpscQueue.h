@@ -0,0 +1,44 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+#include <atomic>
+#include <cstddef>
+
+//lock-free ring buffer for exactly one producer thread and one consumer thread: each
+//index is only ever written by one side, so a release store / acquire load pair is all
+//the synchronisation needed. Capacity must be a power of two; one slot always stays
+//empty so that full and empty can be told apart
+template<typename T, size_t Capacity>
+class SpscQueue {
+	static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+public:
+	SpscQueue() : head(0), tail(0) {}
+
+	//producer only; false if the queue is full
+	bool push(const T& item) {
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t next = (h + 1) & (Capacity - 1);
+		if (next == tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		items[h] = item;
+		head.store(next, std::memory_order_release);
+		return true;
+	}
+	//consumer only; false if the queue is empty
+	bool pop(T& item) {
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t == head.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = items[t];
+		tail.store((t + 1) & (Capacity - 1), std::memory_order_release);
+		return true;
+	}
+private:
+	//each index on its own cache line so the two threads don't keep stealing it from each other
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+	alignas(64) T items[Capacity];
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include "SweepKernel.h"
+#include "GameSimulation.h"
+
+#ifdef BREAKOUT_SSE
+#include <emmintrin.h>
+#endif
+
+void SweepBoxes::clear() {
+	Index.clear();
+	MinX.clear();
+	MinY.clear();
+	MaxX.clear();
+	MaxY.clear();
+}
+
+void SweepBoxes::push(unsigned int index, glm::vec2 min, glm::vec2 max) {
+	Index.push_back(index);
+	MinX.push_back(min.x);
+	MinY.push_back(min.y);
+	MaxX.push_back(max.x);
+	MaxY.push_back(max.y);
+}
+
+static inline float sweepCircleBox(glm::vec2 center, glm::vec2 vel, float radius, float maxT, const SweepBoxes& boxes, unsigned int i) {
+	float hit;
+	glm::vec2 normal;
+	glm::vec2 min{ boxes.MinX[i], boxes.MinY[i] };
+	glm::vec2 max{ boxes.MaxX[i], boxes.MaxY[i] };
+	return GameSimulation::sweepCircleAABB(center, vel, radius, min, max, maxT, hit, normal) ? hit : -1.f;
+}
+
+void sweepCircleBoxesScalar(glm::vec2 center, glm::vec2 vel, float radius, float maxT, const SweepBoxes& boxes, float* t) {
+	for (unsigned int i{ 0 }; i < boxes.size(); ++i) {
+		t[i] = sweepCircleBox(center, vel, radius, maxT, boxes, i);
+	}
+}
+
+#ifdef BREAKOUT_SSE
+//the SSE version of sweepRayAABB, for four boxes. Min/max below are written operand-swapped
+//where needed so they pick exactly what std::min/std::max pick in the scalar code
+static inline __m128 sweepRayBox4(float ox, float oy, float vx, float vy, __m128 minX, __m128 minY, __m128 maxX, __m128 maxY, __m128 maxT, __m128& tOut) {
+	__m128 tEnter = _mm_setzero_ps();
+	__m128 tExit = maxT;
+	__m128 valid = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	const float o[2]{ ox, oy };
+	const float v[2]{ vx, vy };
+	const __m128 mins[2]{ minX, minY };
+	const __m128 maxs[2]{ maxX, maxY };
+	for (int axis{ 0 }; axis < 2; ++axis) {
+		__m128 origin = _mm_set1_ps(o[axis]);
+		if (v[axis] == 0.f) {
+			valid = _mm_andnot_ps(_mm_or_ps(_mm_cmplt_ps(origin, mins[axis]), _mm_cmpgt_ps(origin, maxs[axis])), valid);
+			continue;
+		}
+		__m128 speed = _mm_set1_ps(v[axis]);
+		__m128 t0 = _mm_div_ps(_mm_sub_ps(mins[axis], origin), speed);
+		__m128 t1 = _mm_div_ps(_mm_sub_ps(maxs[axis], origin), speed);
+		__m128 lo = _mm_min_ps(t1, t0);
+		__m128 hi = _mm_max_ps(t0, t1);
+		tEnter = _mm_max_ps(lo, tEnter);
+		tExit = _mm_min_ps(hi, tExit);
+	}
+	valid = _mm_andnot_ps(_mm_cmpgt_ps(tEnter, tExit), valid);
+	valid = _mm_and_ps(valid, _mm_cmpgt_ps(tExit, _mm_setzero_ps()));
+	tOut = tEnter;
+	return valid;
+}
+
+//the SSE version of sweepRayCircle against four corners
+static inline __m128 sweepRayCorner4(float ox, float oy, float vx, float vy, float a, float rr, __m128 cornerX, __m128 cornerY, __m128 maxT, __m128& tOut) {
+	__m128 mx = _mm_sub_ps(_mm_set1_ps(ox), cornerX);
+	__m128 my = _mm_sub_ps(_mm_set1_ps(oy), cornerY);
+	__m128 vvx = _mm_set1_ps(vx), vvy = _mm_set1_ps(vy);
+	__m128 b = _mm_add_ps(_mm_mul_ps(mx, vvx), _mm_mul_ps(my, vvy));
+	__m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(mx, mx), _mm_mul_ps(my, my)), _mm_set1_ps(rr));
+	__m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(_mm_set1_ps(a), c));
+	__m128 valid = _mm_andnot_ps(_mm_cmpgt_ps(b, _mm_setzero_ps()), _mm_cmpge_ps(disc, _mm_setzero_ps()));
+	//lanes that failed already may take the sqrt of a negative; the NaN is masked off
+	__m128 hit = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), b), _mm_sqrt_ps(disc)), _mm_set1_ps(a));
+	valid = _mm_andnot_ps(_mm_cmpgt_ps(hit, maxT), valid);
+	tOut = _mm_max_ps(_mm_setzero_ps(), hit);
+	return valid;
+}
+
+//keeps the smallest valid candidate per lane in best
+static inline void keepEarliest(__m128 valid, __m128 t, __m128& best, __m128& hit) {
+	__m128 take = _mm_and_ps(valid, _mm_or_ps(_mm_cmplt_ps(t, best), _mm_andnot_ps(hit, valid)));
+	best = _mm_or_ps(_mm_and_ps(take, t), _mm_andnot_ps(take, best));
+	hit = _mm_or_ps(hit, valid);
+}
+
+void sweepCircleBoxesSSE(glm::vec2 center, glm::vec2 vel, float radius, float maxT, const SweepBoxes& boxes, float* t) {
+	const unsigned int count = boxes.size();
+	const unsigned int wide = count & ~3u;
+	const float rr = radius * radius;
+	const float a = vel.x * vel.x + vel.y * vel.y;
+	const __m128 r4 = _mm_set1_ps(radius);
+	const __m128 rr4 = _mm_set1_ps(rr);
+	const __m128 maxT4 = _mm_set1_ps(maxT);
+	const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y);
+	const __m128 vx = _mm_set1_ps(vel.x), vy = _mm_set1_ps(vel.y);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 miss = _mm_set1_ps(-1.f);
+
+	for (unsigned int i{ 0 }; i < wide; i += 4) {
+		__m128 minX = _mm_loadu_ps(&boxes.MinX[i]);
+		__m128 minY = _mm_loadu_ps(&boxes.MinY[i]);
+		__m128 maxX = _mm_loadu_ps(&boxes.MaxX[i]);
+		__m128 maxY = _mm_loadu_ps(&boxes.MaxY[i]);
+
+		//already overlapping: a hit at 0 unless we're on our way out
+		__m128 offX = _mm_sub_ps(cx, _mm_min_ps(_mm_max_ps(cx, minX), maxX));
+		__m128 offY = _mm_sub_ps(cy, _mm_min_ps(_mm_max_ps(cy, minY), maxY));
+		__m128 distSq = _mm_add_ps(_mm_mul_ps(offX, offX), _mm_mul_ps(offY, offY));
+		__m128 overlap = _mm_cmplt_ps(distSq, rr4);
+		__m128 leaving = _mm_and_ps(_mm_cmpgt_ps(distSq, zero),
+			_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(vx, offX), _mm_mul_ps(vy, offY)), zero));
+
+		//otherwise the earliest of the two slabs and four corner circles
+		__m128 best = maxT4;
+		__m128 hit = zero;
+		__m128 candidate;
+		__m128 valid = sweepRayBox4(center.x, center.y, vel.x, vel.y, _mm_sub_ps(minX, r4), minY, _mm_add_ps(maxX, r4), maxY, maxT4, candidate);
+		keepEarliest(valid, candidate, best, hit);
+		valid = sweepRayBox4(center.x, center.y, vel.x, vel.y, minX, _mm_sub_ps(minY, r4), maxX, _mm_add_ps(maxY, r4), maxT4, candidate);
+		keepEarliest(valid, candidate, best, hit);
+		if (a != 0.f) {
+			valid = sweepRayCorner4(center.x, center.y, vel.x, vel.y, a, rr, minX, minY, maxT4, candidate);
+			keepEarliest(valid, candidate, best, hit);
+			valid = sweepRayCorner4(center.x, center.y, vel.x, vel.y, a, rr, maxX, minY, maxT4, candidate);
+			keepEarliest(valid, candidate, best, hit);
+			valid = sweepRayCorner4(center.x, center.y, vel.x, vel.y, a, rr, minX, maxY, maxT4, candidate);
+			keepEarliest(valid, candidate, best, hit);
+			valid = sweepRayCorner4(center.x, center.y, vel.x, vel.y, a, rr, maxX, maxY, maxT4, candidate);
+			keepEarliest(valid, candidate, best, hit);
+		}
+
+		__m128 swept = _mm_or_ps(_mm_and_ps(hit, best), _mm_andnot_ps(hit, miss));
+		__m128 touching = _mm_or_ps(_mm_andnot_ps(leaving, zero), _mm_and_ps(leaving, miss));
+		_mm_storeu_ps(&t[i], _mm_or_ps(_mm_and_ps(overlap, touching), _mm_andnot_ps(overlap, swept)));
+	}
+
+	for (unsigned int i{ wide }; i < count; ++i) {
+		t[i] = sweepCircleBox(center, vel, radius, maxT, boxes, i);
+	}
+}
+#endif
+
+void sweepCircleBoxes(glm::vec2 center, glm::vec2 vel, float radius, float maxT, const SweepBoxes& boxes, float* t) {
+#ifdef BREAKOUT_SSE
+	sweepCircleBoxesSSE(center, vel, radius, maxT, boxes, t);
+#else
+	sweepCircleBoxesScalar(center, vel, radius, maxT, boxes, t);
+#endif
+}
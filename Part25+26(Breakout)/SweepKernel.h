@@ -0,0 +1,32 @@
+#ifndef SWEEP_KERNEL_H
+#define SWEEP_KERNEL_H
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Simd.h"
+
+//batched swept-circle tests: one moving ball against a list of boxes, e.g. every brick
+//in the tiles a ball crosses this tick. The boxes are kept as separate coordinate arrays
+//so the SSE path tests four per instruction. Both paths do the same float operations in
+//the same order and give identical times, so which one a build uses never changes the
+//simulation.
+
+struct SweepBoxes {
+	std::vector<unsigned int> Index; //what each box stands for, e.g. a brick index
+	std::vector<float> MinX, MinY, MaxX, MaxY;
+
+	unsigned int size() const { return static_cast<unsigned int>(Index.size()); }
+	void clear();
+	void push(unsigned int index, glm::vec2 min, glm::vec2 max);
+};
+
+//t[i] gets the earliest time in [0, maxT] at which the circle touches box i, the same
+//time GameSimulation::sweepCircleAABB gives, or -1 if it doesn't touch it
+void sweepCircleBoxesScalar(glm::vec2 center, glm::vec2 vel, float radius, float maxT, const SweepBoxes& boxes, float* t);
+#ifdef BREAKOUT_SSE
+void sweepCircleBoxesSSE(glm::vec2 center, glm::vec2 vel, float radius, float maxT, const SweepBoxes& boxes, float* t);
+#endif
+//the fastest of the above this build has
+void sweepCircleBoxes(glm::vec2 center, glm::vec2 vel, float radius, float maxT, const SweepBoxes& boxes, float* t);
+
+#endif
@@ -1,140 +1,260 @@
-/*******************************************************************
-** This code is part of Breakout.
-**
-** Breakout is free software: you can redistribute it and/or modify
-** it under the terms of the CC BY 4.0 license as published by
-** Creative Commons, either version 4 of the License, or (at your
-** option) any later version.
-******************************************************************/
-#include <iostream>
-
-#include <glm/gtc/matrix_transform.hpp>
-#include <ft2build.h>
-#include FT_FREETYPE_H
-
-#include "TextRenderer.h"
-#include "ResourceManager.h"
-
-
-TextRenderer::TextRenderer(unsigned int width, unsigned int height)
-{
-    // load and configure shader
-    this->TextShader = ResourceManager::LoadShader("text_2d.vs", "text_2d.fs", nullptr, "text");
-    this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
-    this->TextShader.SetInteger("text", 0);
-    // configure VAO/VBO for texture quads
-    glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &this->VBO);
-    glBindVertexArray(this->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
-
-void TextRenderer::Load(std::string font, unsigned int fontSize)
-{
-    // first clear the previously loaded Characters
-    this->Characters.clear();
-    // then initialize and load the FreeType library
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft)) // all functions return a value different than 0 whenever an error occurred
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-    // load font as face
-    FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
-        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
-    // set size to load glyphs as
-    FT_Set_Pixel_Sizes(face, 0, fontSize);
-    // disable byte-alignment restriction
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    // then for the first 128 ASCII characters, pre-load/compile their characters and store them
-    for (GLubyte c = 0; c < 128; c++) // lol see what I did there 
-    {
-        // load character glyph 
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-            continue;
-        }
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // now store character for later use
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            face->glyph->advance.x
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
-    }
-    glBindTexture(GL_TEXTURE_2D, 0);
-    // destroy FreeType once we're finished
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
-}
-
-void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
-{
-    // activate corresponding render state	
-    this->TextShader.Use();
-    this->TextShader.SetVector3f("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
-
-    // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
-    {
-        Character ch = Characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 0.0f },
-
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f }
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
-    }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "TextRenderer.h"
+#include "ResourceManager.h"
+
+
+TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+    : Characters(), AtlasTexture(0), vertexCapacity(0), capHeight(0)
+{
+    // load and configure shader
+    this->TextShader = ResourceManager::GetShader(ResourceManager::LoadShader("text_2d.vs", "text_2d.fs", nullptr, "text"));
+    this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
+    this->TextShader.SetInteger("text", 0);
+    // configure VAO/VBO for glyph quads, the buffer is sized on first use
+    this->createVertexArray(this->VAO, this->VBO);
+}
+
+TextRenderer::~TextRenderer()
+{
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+    for (TextMesh& mesh : this->meshes)
+    {
+        glDeleteVertexArrays(1, &mesh.VAO);
+        glDeleteBuffers(1, &mesh.VBO);
+    }
+    glDeleteTextures(1, &this->AtlasTexture);
+}
+
+void TextRenderer::createVertexArray(unsigned int& vao, unsigned int& vbo)
+{
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphVertex), (void*)offsetof(GlyphVertex, x));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GlyphVertex), (void*)offsetof(GlyphVertex, r));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void TextRenderer::Load(std::string font, unsigned int fontSize)
+{
+    // first clear the previously loaded Characters
+    for (Character& ch : this->Characters)
+        ch = Character();
+    glDeleteTextures(1, &this->AtlasTexture);
+    this->AtlasTexture = 0;
+    // then initialize and load the FreeType library
+    FT_Library ft;
+    if (FT_Init_FreeType(&ft)) // all functions return a value different than 0 whenever an error occurred
+        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+    // load font as face
+    FT_Face face;
+    if (FT_New_Face(ft, font.c_str(), 0, &face))
+        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+    // set size to load glyphs as
+    FT_Set_Pixel_Sizes(face, 0, fontSize);
+    // then for the first 128 ASCII characters, render their glyphs and shelf-pack them
+    // left to right into rows of a single atlas, with a pixel of space around each
+    const unsigned int ATLAS_WIDTH = 1024;
+    struct GlyphBitmap { unsigned int x, y, w, h; std::vector<unsigned char> pixels; };
+    std::vector<GlyphBitmap> bitmaps(128);
+    unsigned int penX = 1, penY = 1, rowHeight = 0;
+    for (GLubyte c = 0; c < 128; c++) // lol see what I did there 
+    {
+        // load character glyph 
+        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+        {
+            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+            continue;
+        }
+        FT_Bitmap& bitmap = face->glyph->bitmap;
+        GlyphBitmap& glyph = bitmaps[c];
+        glyph.w = bitmap.width;
+        glyph.h = bitmap.rows;
+        if (penX + glyph.w + 1 > ATLAS_WIDTH)
+        {
+            penX = 1;
+            penY += rowHeight + 1;
+            rowHeight = 0;
+        }
+        glyph.x = penX;
+        glyph.y = penY;
+        penX += glyph.w + 1;
+        rowHeight = std::max(rowHeight, glyph.h);
+        // FreeType rows may be padded, copy them tightly
+        glyph.pixels.resize(glyph.w * glyph.h);
+        for (unsigned int row = 0; row < glyph.h; ++row)
+            std::memcpy(&glyph.pixels[row * glyph.w], bitmap.buffer + row * bitmap.pitch, glyph.w);
+
+        // now store character for later use
+        Character character = {
+            glm::vec4(0.0f),
+            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
+            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
+            static_cast<unsigned int>(face->glyph->advance.x)
+        };
+        this->Characters[c] = character;
+    }
+    unsigned int atlasHeight = 1;
+    while (atlasHeight < penY + rowHeight + 1)
+        atlasHeight *= 2;
+
+    std::vector<unsigned char> atlas(ATLAS_WIDTH * atlasHeight, 0);
+    for (unsigned int c = 0; c < 128; ++c)
+    {
+        GlyphBitmap& glyph = bitmaps[c];
+        for (unsigned int row = 0; row < glyph.h; ++row)
+            std::memcpy(&atlas[(glyph.y + row) * ATLAS_WIDTH + glyph.x], &glyph.pixels[row * glyph.w], glyph.w);
+        this->Characters[c].UV = glm::vec4(glyph.x / (float)ATLAS_WIDTH, glyph.y / (float)atlasHeight,
+            (glyph.x + glyph.w) / (float)ATLAS_WIDTH, (glyph.y + glyph.h) / (float)atlasHeight);
+    }
+    this->capHeight = this->Characters['H'].Bearing.y;
+
+    // disable byte-alignment restriction
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // generate texture
+    glGenTextures(1, &this->AtlasTexture);
+    glBindTexture(GL_TEXTURE_2D, this->AtlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, ATLAS_WIDTH, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+    // set texture options
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    // destroy FreeType once we're finished
+    FT_Done_Face(face);
+    FT_Done_FreeType(ft);
+}
+
+void TextRenderer::RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color)
+{
+    this->QueueText(text, x, y, scale, color);
+    this->Flush();
+}
+
+void TextRenderer::QueueText(const std::string& text, float x, float y, float scale, glm::vec3 color)
+{
+    this->layoutText(text, x, y, scale, color, this->vertices);
+}
+
+void TextRenderer::layoutText(const std::string& text, float x, float y, float scale, glm::vec3 color, std::vector<GlyphVertex>& out)
+{
+    // iterate through all characters
+    for (unsigned char c : text)
+    {
+        if (c >= 128)
+            continue;
+        const Character& ch = this->Characters[c];
+
+        float xpos = x + ch.Bearing.x * scale;
+        float ypos = y + (this->capHeight - ch.Bearing.y) * scale;
+
+        float w = ch.Size.x * scale;
+        float h = ch.Size.y * scale;
+        // two triangles per glyph
+        if (w > 0.0f && h > 0.0f)
+        {
+            const glm::vec4& uv = ch.UV;
+            out.push_back(GlyphVertex{ xpos,     ypos + h, uv.x, uv.w, color.x, color.y, color.z });
+            out.push_back(GlyphVertex{ xpos + w, ypos,     uv.z, uv.y, color.x, color.y, color.z });
+            out.push_back(GlyphVertex{ xpos,     ypos,     uv.x, uv.y, color.x, color.y, color.z });
+
+            out.push_back(GlyphVertex{ xpos,     ypos + h, uv.x, uv.w, color.x, color.y, color.z });
+            out.push_back(GlyphVertex{ xpos + w, ypos + h, uv.z, uv.w, color.x, color.y, color.z });
+            out.push_back(GlyphVertex{ xpos + w, ypos,     uv.z, uv.y, color.x, color.y, color.z });
+        }
+        // now advance cursors for next glyph
+        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
+    }
+}
+
+void TextRenderer::Flush()
+{
+    if (this->vertices.empty())
+        return;
+    // activate corresponding render state	
+    this->TextShader.Use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, this->AtlasTexture);
+    glBindVertexArray(this->VAO);
+    // upload the whole stream, orphaning the old buffer (growing it if needed)
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    if (this->vertices.size() > this->vertexCapacity)
+        this->vertexCapacity = this->vertices.size() * 2;
+    glBufferData(GL_ARRAY_BUFFER, this->vertexCapacity * sizeof(GlyphVertex), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->vertices.size() * sizeof(GlyphVertex), this->vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // render every queued quad
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)this->vertices.size());
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    this->vertices.clear();
+}
+
+TextMeshHandle TextRenderer::CreateText()
+{
+    TextMesh mesh = {};
+    this->createVertexArray(mesh.VAO, mesh.VBO);
+    this->meshes.push_back(mesh);
+    return TextMeshHandle{ static_cast<unsigned int>(this->meshes.size() - 1) };
+}
+
+void TextRenderer::SetText(TextMeshHandle handle, const std::string& text, float x, float y, float scale, glm::vec3 color)
+{
+    TextMesh& mesh = this->meshes[handle.Index];
+    if (mesh.VertexCount > 0 && mesh.Text == text && mesh.X == x && mesh.Y == y && mesh.Scale == scale && mesh.Color == color)
+        return;
+    mesh.Text = text;
+    mesh.X = x;
+    mesh.Y = y;
+    mesh.Scale = scale;
+    mesh.Color = color;
+    // lay out through a scratch vector of its own, so once it has grown rebuilding doesn't allocate
+    this->meshVertices.clear();
+    this->layoutText(text, x, y, scale, color, this->meshVertices);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    if (this->meshVertices.size() > mesh.Capacity)
+    {
+        mesh.Capacity = this->meshVertices.size();
+        glBufferData(GL_ARRAY_BUFFER, mesh.Capacity * sizeof(GlyphVertex), this->meshVertices.data(), GL_STATIC_DRAW);
+    }
+    else
+        glBufferSubData(GL_ARRAY_BUFFER, 0, this->meshVertices.size() * sizeof(GlyphVertex), this->meshVertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    mesh.VertexCount = (unsigned int)this->meshVertices.size();
+}
+
+void TextRenderer::DrawText(TextMeshHandle handle)
+{
+    const TextMesh& mesh = this->meshes[handle.Index];
+    if (mesh.VertexCount == 0)
+        return;
+    this->TextShader.Use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, this->AtlasTexture);
+    glBindVertexArray(mesh.VAO);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)mesh.VertexCount);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
\ No newline at end of file
@@ -1,51 +1,99 @@
-/*******************************************************************
-** This code is part of Breakout.
-**
-** Breakout is free software: you can redistribute it and/or modify
-** it under the terms of the CC BY 4.0 license as published by
-** Creative Commons, either version 4 of the License, or (at your
-** option) any later version.
-******************************************************************/
-#ifndef TEXT_RENDERER_H
-#define TEXT_RENDERER_H
-
-#include <map>
-
-#include <glad/glad.h>
-#include <glm/glm.hpp>
-
-#include "texture.h"
-#include "shader.h"
-
-
-/// Holds all state information relevant to a character as loaded using FreeType
-struct Character {
-    unsigned int TextureID; // ID handle of the glyph texture
-    glm::ivec2   Size;      // size of glyph
-    glm::ivec2   Bearing;   // offset from baseline to left/top of glyph
-    unsigned int Advance;   // horizontal offset to advance to next glyph
-};
-
-
-// A renderer class for rendering text displayed by a font loaded using the 
-// FreeType library. A single font is loaded, processed into a list of Character
-// items for later rendering.
-class TextRenderer
-{
-public:
-    // holds a list of pre-compiled Characters
-    std::map<char, Character> Characters;
-    // shader used for text rendering
-    Shader TextShader;
-    // constructor
-    TextRenderer(unsigned int width, unsigned int height);
-    // pre-compiles a list of characters from the given font
-    void Load(std::string font, unsigned int fontSize);
-    // renders a string of text using the precompiled list of characters
-    void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
-private:
-    // render state
-    unsigned int VAO, VBO;
-};
-
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+#include "shader.h"
+
+
+/// Holds all state information relevant to a character as loaded using FreeType
+struct Character {
+    glm::vec4    UV;        // rect of the glyph in the atlas texture: u0, v0, u1, v1
+    glm::ivec2   Size;      // size of glyph
+    glm::ivec2   Bearing;   // offset from baseline to left/top of glyph
+    unsigned int Advance;   // horizontal offset to advance to next glyph
+};
+
+/// One corner of a glyph quad
+struct GlyphVertex {
+    float x, y;    // screen position
+    float u, v;    // atlas coordinates
+    float r, g, b; // text color
+};
+
+
+/// A retained string: laid out once into its own vertex buffer and only
+/// rebuilt when its text, position, scale or color change
+struct TextMesh {
+    unsigned int VAO, VBO;
+    unsigned int VertexCount;
+    size_t       Capacity;
+    std::string  Text;
+    float        X, Y, Scale;
+    glm::vec3    Color;
+};
+
+/// Index of a TextMesh owned by a TextRenderer
+struct TextMeshHandle { unsigned int Index; };
+
+
+// A renderer class for rendering text displayed by a font loaded using the 
+// FreeType library. A single font is loaded, its glyphs packed into one atlas
+// texture and indexed by a flat table of Character items. Strings are laid
+// out into one vertex stream, so any amount of text is a single draw call.
+class TextRenderer
+{
+public:
+    // pre-compiled Characters for the first 128 ASCII codes
+    Character Characters[128];
+    // texture holding every glyph
+    unsigned int AtlasTexture;
+    // shader used for text rendering
+    Shader TextShader;
+    // constructor
+    TextRenderer(unsigned int width, unsigned int height);
+    ~TextRenderer();
+    // pre-compiles a list of characters from the given font
+    void Load(std::string font, unsigned int fontSize);
+    // renders a string of text (and anything queued before it) with one draw call
+    void RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // lays out a string to be drawn by the next Flush, so a whole frame of text can be one draw call
+    void QueueText(const std::string& text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // draws everything queued since the last Flush
+    void Flush();
+    // creates an empty retained text object
+    TextMeshHandle CreateText();
+    // sets a retained text object's contents; does nothing unless something actually changed
+    void SetText(TextMeshHandle handle, const std::string& text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // draws a retained text object with one draw call and no layout work
+    void DrawText(TextMeshHandle handle);
+private:
+    std::vector<TextMesh> meshes;
+    // render state
+    unsigned int VAO, VBO;
+    size_t vertexCapacity;
+    std::vector<GlyphVertex> vertices;
+    // SetText lays meshes out here, separate from the queue so it keeps its capacity
+    std::vector<GlyphVertex> meshVertices;
+    // top bearing of 'H', used to line every glyph up on the same cap height
+    int capHeight;
+    // creates a VAO/VBO pair laid out for GlyphVertex
+    void createVertexArray(unsigned int& vao, unsigned int& vbo);
+    // appends the quads for a string to out
+    void layoutText(const std::string& text, float x, float y, float scale, glm::vec3 color, std::vector<GlyphVertex>& out);
+};
+
 #endif 
\ No newline at end of file
@@ -1,39 +1,78 @@
-/*******************************************************************
-** This code is part of Breakout.
-**
-** Breakout is free software: you can redistribute it and/or modify
-** it under the terms of the CC BY 4.0 license as published by
-** Creative Commons, either version 4 of the License, or (at your
-** option) any later version.
-******************************************************************/
-#include <iostream>
-
-#include "texture.h"
-
-
-Texture2D::Texture2D()
-    : Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
-{
-    glGenTextures(1, &this->ID);
-}
-
-void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
-{
-    this->Width = width;
-    this->Height = height;
-    // create Texture
-    glBindTexture(GL_TEXTURE_2D, this->ID);
-    glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
-    // set Texture wrap and filter modes
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->Wrap_S);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->Wrap_T);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
-    // unbind texture
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
-
-void Texture2D::Bind() const
-{
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include <iostream>
+#include <utility>
+
+#include "texture.h"
+
+
+Texture2D::Texture2D()
+    : ID(0), Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR), Max_Level(1000)
+{
+
+}
+
+Texture2D::~Texture2D()
+{
+    // glDeleteTextures ignores 0, but a texture that was never generated shouldn't need a GL context to go away
+    if (this->ID != 0)
+        glDeleteTextures(1, &this->ID);
+}
+
+Texture2D::Texture2D(Texture2D&& other) noexcept
+    : ID(other.ID), Width(other.Width), Height(other.Height), Internal_Format(other.Internal_Format), Image_Format(other.Image_Format),
+    Wrap_S(other.Wrap_S), Wrap_T(other.Wrap_T), Filter_Min(other.Filter_Min), Filter_Max(other.Filter_Max), Max_Level(other.Max_Level)
+{
+    other.ID = 0;
+}
+
+Texture2D& Texture2D::operator=(Texture2D&& other) noexcept
+{
+    // swapping hands our old texture to other, which deletes it
+    std::swap(this->ID, other.ID);
+    this->Width = other.Width;
+    this->Height = other.Height;
+    this->Internal_Format = other.Internal_Format;
+    this->Image_Format = other.Image_Format;
+    this->Wrap_S = other.Wrap_S;
+    this->Wrap_T = other.Wrap_T;
+    this->Filter_Min = other.Filter_Min;
+    this->Filter_Max = other.Filter_Max;
+    this->Max_Level = other.Max_Level;
+    return *this;
+}
+
+void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
+{
+    if (this->ID == 0)
+        glGenTextures(1, &this->ID);
+    this->Width = width;
+    this->Height = height;
+    // create Texture
+    glBindTexture(GL_TEXTURE_2D, this->ID);
+    glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
+    // set Texture wrap and filter modes
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->Wrap_S);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->Wrap_T);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
+    // build the mip chain if the min filter samples from it
+    if (this->Filter_Min != GL_LINEAR && this->Filter_Min != GL_NEAREST)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, this->Max_Level);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    // unbind texture
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture2D::Bind() const
+{
+    glBindTexture(GL_TEXTURE_2D, this->ID);
 }
\ No newline at end of file
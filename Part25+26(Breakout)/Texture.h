@@ -1,39 +1,70 @@
-/*******************************************************************
-** This code is part of Breakout.
-**
-** Breakout is free software: you can redistribute it and/or modify
-** it under the terms of the CC BY 4.0 license as published by
-** Creative Commons, either version 4 of the License, or (at your
-** option) any later version.
-******************************************************************/
-#ifndef TEXTURE_H
-#define TEXTURE_H
-
-#include <glad/glad.h>
-
-// Texture2D is able to store and configure a texture in OpenGL.
-// It also hosts utility functions for easy management.
-class Texture2D
-{
-public:
-    // holds the ID of the texture object, used for all texture operations to reference to this particular texture
-    unsigned int ID;
-    // texture image dimensions
-    unsigned int Width, Height; // width and height of loaded image in pixels
-    // texture Format
-    unsigned int Internal_Format; // format of texture object
-    unsigned int Image_Format; // format of loaded image
-    // texture configuration
-    unsigned int Wrap_S; // wrapping mode on S axis
-    unsigned int Wrap_T; // wrapping mode on T axis
-    unsigned int Filter_Min; // filtering mode if texture pixels < screen pixels
-    unsigned int Filter_Max; // filtering mode if texture pixels > screen pixels
-    // constructor (sets default texture modes)
-    Texture2D();
-    // generates texture from image data
-    void Generate(unsigned int width, unsigned int height, unsigned char* data);
-    // binds the texture as the current active GL_TEXTURE_2D texture object
-    void Bind() const;
-};
-
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// A non-owning reference to a texture; trivially copyable, so it can be
+// stored and passed around freely. It is only valid while the Texture2D
+// it came from (normally one held by the ResourceManager) is alive.
+struct TextureRef
+{
+    unsigned int ID;
+    unsigned int Width, Height;
+    // binds the texture as the current active GL_TEXTURE_2D texture object
+    void Bind() const { glBindTexture(GL_TEXTURE_2D, this->ID); }
+};
+
+// Texture2D is able to store and configure a texture in OpenGL.
+// It also hosts utility functions for easy management.
+// It owns its GL texture: the name is created by the first Generate()
+// and deleted with the object, so a Texture2D can be moved but not copied.
+// Everything that only draws with a texture should hold a TextureRef.
+class Texture2D
+{
+public:
+    // holds the ID of the texture object, used for all texture operations to reference to this particular texture; 0 until generated
+    unsigned int ID;
+    // texture image dimensions
+    unsigned int Width, Height; // width and height of loaded image in pixels
+    // texture Format
+    unsigned int Internal_Format; // format of texture object
+    unsigned int Image_Format; // format of loaded image
+    // texture configuration
+    unsigned int Wrap_S; // wrapping mode on S axis
+    unsigned int Wrap_T; // wrapping mode on T axis
+    unsigned int Filter_Min; // filtering mode if texture pixels < screen pixels
+    unsigned int Filter_Max; // filtering mode if texture pixels > screen pixels
+    unsigned int Max_Level; // highest mip level to build when Filter_Min is a mipmap filter
+    // constructor (sets default texture modes, no GL calls)
+    Texture2D();
+    ~Texture2D();
+    Texture2D(const Texture2D&) = delete;
+    Texture2D& operator=(const Texture2D&) = delete;
+    Texture2D(Texture2D&& other) noexcept;
+    Texture2D& operator=(Texture2D&& other) noexcept;
+    // generates texture from image data, creating the GL texture on first use
+    void Generate(unsigned int width, unsigned int height, unsigned char* data);
+    // binds the texture as the current active GL_TEXTURE_2D texture object
+    void Bind() const;
+    // a non-owning reference for drawing with
+    TextureRef Ref() const { return TextureRef{ this->ID, this->Width, this->Height }; }
+};
+
+// A named sprite inside an atlas texture, addressed by its UV sub-rectangle
+struct AtlasSprite
+{
+    unsigned int TextureID; // ID of the atlas texture
+    glm::vec4    UV;        // u0, v0, u1, v1
+    glm::ivec2   Size;      // size of the sprite in pixels
+};
+
 #endif
\ No newline at end of file
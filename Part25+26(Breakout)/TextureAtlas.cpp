@@ -0,0 +1,146 @@
+#include "TextureAtlas.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+#include "stb_image.h"
+
+static const char ATLAS_MAGIC[4]{ 'A', 'T', 'L', 'S' };
+static const unsigned int ATLAS_VERSION{ 1 };
+
+//the uint32 fields are little endian whatever the host is
+static void writeU32s(std::ofstream& out, const unsigned int* v, unsigned int count) {
+	for (unsigned int i{ 0 }; i < count; ++i) {
+		unsigned char b[4]{ (unsigned char)v[i], (unsigned char)(v[i] >> 8), (unsigned char)(v[i] >> 16), (unsigned char)(v[i] >> 24) };
+		out.write(reinterpret_cast<const char*>(b), 4);
+	}
+}
+static bool readU32s(std::ifstream& in, unsigned int* v, unsigned int count) {
+	for (unsigned int i{ 0 }; i < count; ++i) {
+		unsigned char b[4];
+		if (!in.read(reinterpret_cast<char*>(b), 4)) {
+			return false;
+		}
+		v[i] = b[0] | (b[1] << 8) | (b[2] << 16) | ((unsigned int)b[3] << 24);
+	}
+	return true;
+}
+
+struct LoadedSprite {
+	unsigned int source;
+	int w, h;
+	unsigned char* data;
+};
+
+bool packAtlas(const std::vector<AtlasSource>& sources, unsigned int padding, AtlasImage& atlas) {
+	std::vector<LoadedSprite> sprites;
+	bool ok = true;
+	for (unsigned int i{ 0 }; i < sources.size(); ++i) {
+		int w, h, channels;
+		unsigned char* data = stbi_load(sources[i].file.c_str(), &w, &h, &channels, 4);
+		if (!data) {
+			std::cout << "ERROR::ATLAS: Failed to load " << sources[i].file << std::endl;
+			ok = false;
+			continue;
+		}
+		sprites.push_back(LoadedSprite{ i, w, h, data });
+	}
+
+	//shelf packing: tallest first, rows left to right, width a power of two wide enough
+	//for the widest sprite and roughly square overall
+	std::sort(sprites.begin(), sprites.end(), [](const LoadedSprite& a, const LoadedSprite& b) { return a.h > b.h; });
+	unsigned long long area = 0;
+	unsigned int widest = 0;
+	for (const LoadedSprite& s : sprites) {
+		area += (unsigned long long)(s.w + 2 * padding) * (s.h + 2 * padding);
+		widest = std::max(widest, s.w + 2 * padding);
+	}
+	unsigned int width = 1;
+	while (width < widest || (unsigned long long)width * width < area) {
+		width *= 2;
+	}
+
+	atlas.rects.clear();
+	unsigned int x = 0, y = 0, shelf = 0;
+	for (const LoadedSprite& s : sprites) {
+		unsigned int w = s.w + 2 * padding, h = s.h + 2 * padding;
+		if (x + w > width) {
+			x = 0;
+			y += shelf;
+			shelf = 0;
+		}
+		atlas.rects.push_back(AtlasRect{ sources[s.source].name, x + padding, y + padding, (unsigned int)s.w, (unsigned int)s.h });
+		x += w;
+		shelf = std::max(shelf, h);
+	}
+	unsigned int height = 1;
+	while (height < y + shelf) {
+		height *= 2;
+	}
+
+	atlas.width = width;
+	atlas.height = height;
+	atlas.padding = padding;
+	atlas.pixels.assign((size_t)width * height * 4, 0);
+	for (unsigned int i{ 0 }; i < sprites.size(); ++i) {
+		const LoadedSprite& s = sprites[i];
+		const AtlasRect& r = atlas.rects[i];
+		//copy, clamping into the source so the padding repeats the edge pixels
+		for (int py{ -(int)padding }; py < s.h + (int)padding; ++py) {
+			int sy = std::min(std::max(py, 0), s.h - 1);
+			for (int px{ -(int)padding }; px < s.w + (int)padding; ++px) {
+				int sx = std::min(std::max(px, 0), s.w - 1);
+				std::memcpy(&atlas.pixels[(((size_t)r.y + py) * width + r.x + px) * 4], &s.data[((size_t)sy * s.w + sx) * 4], 4);
+			}
+		}
+		stbi_image_free(s.data);
+	}
+	return ok;
+}
+
+bool writeAtlas(const char* file, const AtlasImage& atlas) {
+	std::ofstream out(file, std::ios::binary);
+	if (!out) {
+		std::cout << "ERROR::ATLAS: Failed to open " << file << " for writing" << std::endl;
+		return false;
+	}
+	unsigned int header[5]{ ATLAS_VERSION, atlas.width, atlas.height, atlas.padding, (unsigned int)atlas.rects.size() };
+	out.write(ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+	writeU32s(out, header, 5);
+	for (const AtlasRect& r : atlas.rects) {
+		unsigned int rect[5]{ r.x, r.y, r.w, r.h, (unsigned int)r.name.size() };
+		writeU32s(out, rect, 5);
+		out.write(r.name.data(), r.name.size());
+	}
+	out.write(reinterpret_cast<const char*>(atlas.pixels.data()), atlas.pixels.size());
+	return (bool)out;
+}
+
+bool readAtlas(const char* file, AtlasImage& atlas) {
+	std::ifstream in(file, std::ios::binary);
+	char magic[4];
+	unsigned int header[5];
+	if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, ATLAS_MAGIC, sizeof(magic)) != 0
+		|| !readU32s(in, header, 5) || header[0] != ATLAS_VERSION) {
+		return false;
+	}
+	atlas.width = header[1];
+	atlas.height = header[2];
+	atlas.padding = header[3];
+	atlas.rects.resize(header[4]);
+	for (AtlasRect& r : atlas.rects) {
+		unsigned int rect[5];
+		if (!readU32s(in, rect, 5)) {
+			return false;
+		}
+		r.x = rect[0]; r.y = rect[1]; r.w = rect[2]; r.h = rect[3];
+		r.name.resize(rect[4]);
+		if (!in.read(&r.name[0], rect[4])) {
+			return false;
+		}
+	}
+	atlas.pixels.resize((size_t)atlas.width * atlas.height * 4);
+	return (bool)in.read(reinterpret_cast<char*>(atlas.pixels.data()), atlas.pixels.size());
+}
@@ -0,0 +1,38 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+#include <string>
+#include <vector>
+
+//packing and file IO for sprite atlases. Nothing in here touches GL, so atlases can
+//be built offline (BreakoutHeadless --build-atlas) and ResourceManager::LoadAtlas
+//only has to read one file and upload it.
+//
+//.atlas layout (little endian):
+//  char[4] "ATLS", uint32 version, uint32 width, uint32 height, uint32 padding, uint32 count
+//  count x { uint32 x, y, w, h, uint32 nameLength, char name[nameLength] }
+//  width * height RGBA8 pixels, top row first
+
+struct AtlasRect {
+	std::string name;
+	unsigned int x, y, w, h;
+};
+
+struct AtlasImage {
+	unsigned int width, height;
+	unsigned int padding;
+	std::vector<AtlasRect> rects;
+	std::vector<unsigned char> pixels;
+};
+
+struct AtlasSource {
+	std::string name;
+	std::string file;
+};
+
+//packs the images into one RGBA image, padding each sprite by repeating its edge pixels
+//so filtering and the first few mip levels don't bleed between neighbours
+bool packAtlas(const std::vector<AtlasSource>& sources, unsigned int padding, AtlasImage& atlas);
+bool writeAtlas(const char* file, const AtlasImage& atlas);
+bool readAtlas(const char* file, AtlasImage& atlas);
+
+#endif
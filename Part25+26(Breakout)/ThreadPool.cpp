@@ -0,0 +1,105 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+//which pool and worker the current thread belongs to, so submit() from inside a task
+//can push to its own deque
+static thread_local ThreadPool* currentPool{ nullptr };
+static thread_local unsigned int currentWorker{ 0 };
+
+ThreadPool::ThreadPool(unsigned int count)
+	: queued(0), pending(0), nextWorker(0), stopping(false), executed(0), stolen(0)
+{
+	if (count == 0) {
+		count = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (unsigned int i{ 0 }; i < count; ++i) {
+		workers.emplace_back(new Worker());
+	}
+	for (unsigned int i{ 0 }; i < count; ++i) {
+		threads.emplace_back(&ThreadPool::run, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	wait();
+	{
+		std::lock_guard<std::mutex> lock(sleepLock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+	unsigned int target = currentPool == this ? currentWorker : nextWorker++ % size();
+	pending++;
+	{
+		std::lock_guard<std::mutex> lock(workers[target]->lock);
+		workers[target]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleepLock);
+		queued++;
+	}
+	wake.notify_one();
+}
+
+void ThreadPool::wait() {
+	std::unique_lock<std::mutex> lock(sleepLock);
+	idle.wait(lock, [this]() { return pending == 0; });
+}
+
+bool ThreadPool::take(unsigned int worker, std::function<void()>& task) {
+	bool found = false;
+	{
+		Worker& own = *workers[worker];
+		std::lock_guard<std::mutex> lock(own.lock);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			found = true;
+		}
+	}
+	for (unsigned int i{ 1 }; !found && i < size(); ++i) {
+		Worker& victim = *workers[(worker + i) % size()];
+		std::lock_guard<std::mutex> lock(victim.lock);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			found = true;
+			stolen++;
+		}
+	}
+	if (found) {
+		std::lock_guard<std::mutex> lock(sleepLock);
+		queued--;
+	}
+	return found;
+}
+
+void ThreadPool::run(unsigned int worker) {
+	currentPool = this;
+	currentWorker = worker;
+	std::function<void()> task;
+	while (true) {
+		if (take(worker, task)) {
+			task();
+			task = nullptr;
+			executed++;
+			if (--pending == 0) {
+				//lock so this can't land between wait() checking pending and going to sleep
+				std::lock_guard<std::mutex> lock(sleepLock);
+				idle.notify_all();
+			}
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepLock);
+		wake.wait(lock, [this]() { return stopping || queued > 0; });
+		if (stopping && queued == 0) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+//fixed set of worker threads with a task deque each. A worker runs its own deque newest
+//first and, once that's empty, steals the oldest task from the others, so uneven tasks
+//(a game that ends early next to one that runs to the tick limit) don't leave threads idle.
+//Tasks submitted from outside are dealt round robin, tasks submitted from inside a task
+//go to the deque of the worker running it
+class ThreadPool {
+public:
+	//0 means one per hardware thread
+	explicit ThreadPool(unsigned int threads = 0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned int size() const { return static_cast<unsigned int>(threads.size()); }
+	void submit(std::function<void()> task);
+	//blocks until every task submitted so far, and everything they submitted, has run
+	void wait();
+
+	struct Stats {
+		unsigned long long executed, stolen;
+	};
+	Stats stats() const { return Stats{ executed.load(), stolen.load() }; }
+private:
+	struct Worker {
+		std::mutex lock;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::vector<std::thread> threads;
+
+	//queued counts tasks sitting in a deque and is only changed under sleepLock, so a
+	//worker can't miss the wakeup for a task pushed while it was deciding to sleep;
+	//pending also counts the ones running
+	std::mutex sleepLock;
+	std::condition_variable wake, idle;
+	unsigned int queued;
+	std::atomic<unsigned int> pending;
+	std::atomic<unsigned int> nextWorker;
+	bool stopping;
+
+	std::atomic<unsigned long long> executed, stolen;
+
+	bool take(unsigned int worker, std::function<void()>& task);
+	void run(unsigned int worker);
+};
+
+#endif
@@ -0,0 +1,11 @@
+#version 330 core
+in vec2 Offset;
+in vec4 ParticleColor;
+out vec4 color;
+
+void main()
+{
+    // a soft round dot, no texture; drawn additively so overlapping particles glow
+    float falloff = clamp(1.0 - dot(Offset, Offset), 0.0, 1.0);
+    color = vec4(ParticleColor.rgb, ParticleColor.a * falloff * falloff);
+}
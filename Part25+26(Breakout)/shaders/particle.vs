@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in float centerX;
+layout (location = 2) in float centerY;
+layout (location = 3) in float life; // 1 when spawned, 0 when gone
+layout (location = 4) in float size;
+layout (location = 5) in vec4 tint; // RGBA8, normalized
+
+out vec2 Offset;
+out vec4 ParticleColor;
+
+uniform mat4 projection;
+
+void main()
+{
+    // a square of the particle's size centered on it, fading out with its life
+    Offset = vertex.zw * 2.0 - 1.0;
+    ParticleColor = vec4(tint.rgb, tint.a * life);
+    vec2 world = vec2(centerX, centerY) + (vertex.xy - 0.5) * size;
+    gl_Position = projection * vec4(world, 0.0, 1.0);
+}
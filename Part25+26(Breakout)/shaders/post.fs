@@ -0,0 +1,49 @@
+#version 330 core
+out vec4 color;
+
+uniform sampler2DMS scene;
+uniform int samples;
+uniform float shake; // pixels, 0 when off
+uniform float time;
+uniform bool confuse; // invert colors
+uniform bool chaos; // edge detection
+uniform float vignette; // 0-1
+
+// the MSAA resolve: the average of every sample in the pixel, clamped to the edges
+vec3 resolved(ivec2 pixel)
+{
+    pixel = clamp(pixel, ivec2(0), textureSize(scene) - 1);
+    vec3 sum = vec3(0.0);
+    for (int i = 0; i < samples; ++i)
+        sum += texelFetch(scene, pixel, i).rgb;
+    return sum / float(samples);
+}
+
+void main()
+{
+    // shake moves where we read from rather than the quad, so the borders stay filled
+    vec2 offset = shake * vec2(cos(time * 50.0), cos(time * 37.0));
+    ivec2 pixel = ivec2(gl_FragCoord.xy + offset);
+
+    vec3 result;
+    if (chaos)
+    {
+        // 3x3 laplacian edge detect over the resolved pixels
+        result = 8.0 * resolved(pixel);
+        for (int y = -1; y <= 1; ++y)
+            for (int x = -1; x <= 1; ++x)
+                if (x != 0 || y != 0)
+                    result -= resolved(pixel + ivec2(x, y));
+    }
+    else
+        result = resolved(pixel);
+
+    if (confuse)
+        result = vec3(1.0) - result;
+
+    vec2 uv = gl_FragCoord.xy / vec2(textureSize(scene));
+    float edge = length(uv - 0.5) * 1.41421356;
+    result *= 1.0 - vignette * smoothstep(0.4, 1.0, edge);
+
+    color = vec4(result, 1.0);
+}
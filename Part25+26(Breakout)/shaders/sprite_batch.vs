@@ -0,0 +1,25 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4 rect; // <vec2 position, vec2 size>
+layout (location = 2) in vec4 colorRotate; // <vec3 color, float rotate (degrees)>
+layout (location = 3) in vec4 uvRect; // <vec2 uv min, vec2 uv max>, the whole texture unless it's an atlas sprite
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+
+uniform mat4 projection;
+
+void main()
+{
+    // the same model matrix drawSprite builds: scale, rotate around the center, translate
+    vec2 local = (vertex.xy - 0.5) * rect.zw;
+    float angle = radians(colorRotate.w);
+    float c = cos(angle);
+    float s = sin(angle);
+    vec2 rotated = vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+    vec2 world = rect.xy + 0.5 * rect.zw + rotated;
+
+    TexCoords = mix(uvRect.xy, uvRect.zw, vertex.zw);
+    SpriteColor = colorRotate.rgb;
+    gl_Position = projection * vec4(world, 0.0, 1.0);
+}
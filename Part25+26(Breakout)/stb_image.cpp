@@ -0,0 +1,4 @@
+//the stb_image implementation gets its own translation unit so both the game and the
+//GL-free tools (atlas building) can link it
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"